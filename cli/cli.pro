@@ -0,0 +1,41 @@
+# Component Organizer
+# Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+QT       += core gui
+
+TARGET = comporg-cli
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+DEFINES += QT_NO_DEBUG_OUTPUT
+DEFINES += QT_NO_DEBUG
+
+include(../core/core.pri)
+
+SOURCES += main.cpp \
+    jsonwriter.cpp
+
+HEADERS  += jsonwriter.h
+
+OBJECTS_DIR =   _build/tmp/obj
+MOC_DIR =       _build/tmp/moc
+
+CONFIG(debug, debug|release) {
+    DESTDIR = ../_build/debug/bin
+} else {
+    DESTDIR = ../_build/release/bin
+}
@@ -0,0 +1,138 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "jsonwriter.h"
+
+JsonWriter::JsonWriter()
+{
+}
+
+void JsonWriter::prefix(const QString &key)
+{
+    if(!m_first.isEmpty())
+    {
+        if(!m_first.last())
+            m_text += ',';
+        m_first.last() = false;
+
+        if(!m_inArray.last())
+            m_text += quote(key) + ':';
+    }
+}
+
+void JsonWriter::beginObject(const QString &key)
+{
+    prefix(key);
+    m_text += '{';
+    m_first.append(true);
+    m_inArray.append(false);
+}
+
+void JsonWriter::endObject()
+{
+    m_text += '}';
+    m_first.removeLast();
+    m_inArray.removeLast();
+}
+
+void JsonWriter::beginArray(const QString &key)
+{
+    prefix(key);
+    m_text += '[';
+    m_first.append(true);
+    m_inArray.append(true);
+}
+
+void JsonWriter::endArray()
+{
+    m_text += ']';
+    m_first.removeLast();
+    m_inArray.removeLast();
+}
+
+void JsonWriter::value(const QString &key, const QString &value)
+{
+    prefix(key);
+    m_text += quote(value);
+}
+
+void JsonWriter::value(const QString &key, const char *value)
+{
+    this->value(key, QString::fromUtf8(value));
+}
+
+void JsonWriter::value(const QString &key, int value)
+{
+    prefix(key);
+    m_text += QString::number(value);
+}
+
+void JsonWriter::value(const QString &key, double value)
+{
+    prefix(key);
+    m_text += QString::number(value, 'f', 2);
+}
+
+void JsonWriter::value(const QString &key, bool value)
+{
+    prefix(key);
+    m_text += value ? "true" : "false";
+}
+
+void JsonWriter::value(const QString &key, const QStringList &values)
+{
+    beginArray(key);
+    foreach(const QString &v, values)
+        value(QString(), v);
+    endArray();
+}
+
+QString JsonWriter::quote(const QString &text)
+{
+    QString result = "\"";
+
+    for(int i = 0; i < text.size(); i++)
+    {
+        QChar c = text.at(i);
+        switch(c.unicode())
+        {
+            case '"':
+                result += "\\\"";
+                break;
+            case '\\':
+                result += "\\\\";
+                break;
+            case '\n':
+                result += "\\n";
+                break;
+            case '\r':
+                result += "\\r";
+                break;
+            case '\t':
+                result += "\\t";
+                break;
+            default:
+                if(c.unicode() < 0x20)
+                    result += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+                else
+                    result += c;
+        }
+    }
+
+    return result + '"';
+}
@@ -0,0 +1,61 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+// Minimal JSON output for comporg-cli, built up in document order. Keys
+// are ignored inside arrays. The result is a single line, so that several
+// documents can be streamed one per line.
+class JsonWriter
+{
+public:
+    JsonWriter();
+
+    void beginObject(const QString &key = QString());
+    void endObject();
+    void beginArray(const QString &key = QString());
+    void endArray();
+
+    void value(const QString &key, const QString &value);
+    void value(const QString &key, const char *value);
+    void value(const QString &key, int value);
+    void value(const QString &key, double value);
+    void value(const QString &key, bool value);
+    void value(const QString &key, const QStringList &values);
+
+    QString toString() const
+    {
+        return m_text;
+    }
+
+    static QString quote(const QString &text);
+
+private:
+    QString m_text;
+    QList<bool> m_first;            // per open scope: nothing written yet
+    QList<bool> m_inArray;
+
+    void prefix(const QString &key);
+};
+
+#endif // JSONWRITER_H
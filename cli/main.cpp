@@ -0,0 +1,836 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+#include <QTextCodec>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QRegExp>
+#include <QDateTime>
+#include <QXmlStreamWriter>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "co.h"
+#include "co_defs.h"
+#include "bom.h"
+#include "smtprogram.h"
+#include "smtprofilelibrary.h"
+#include "smtbatch.h"
+#include "stockreservation.h"
+#include "shortageplanner.h"
+#include "component.h"
+#include "stock.h"
+#include "package.h"
+#include "datasheet.h"
+#include "jsonwriter.h"
+
+// Exit codes
+enum
+{
+    ExitOk = 0,
+    ExitFailed = 1,     // at least one file could not be processed
+    ExitUsage = 2
+};
+
+struct Options
+{
+    QString command;
+    QString dataPath;
+    QString profilePath;
+    int boards;
+    int components;
+    bool force;
+    bool optimize;
+    QString pcbName;
+    QString placePath;
+    QString bomPath;
+    QString outPath;
+    QString panel;
+    QDateTime at;
+    QDateTime from;
+    QDateTime to;
+    QStringList files;
+};
+
+static QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+static QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+static void usage()
+{
+    err() << "usage: comporg-cli [--data data.xml] check|reduce|add|max [--boards N] [--force] BOM...\n"
+          << "       comporg-cli [--data data.xml] [--profiles DIR] smt --pcb NAME --place FILE\n"
+          << "                   [--bom FILE] [--out FILE] [--optimize]\n"
+          << "                   [--panel \"RxC [pitch=X,Y] [size=W,H] [rotation=A,...] [badmark=X,Y]\"]\n"
+          << "       comporg-cli [--data data.xml] plan [--boards N] [--out FILE.csv] BOM[:N]...\n"
+          << "       comporg-cli [--data data.xml] history --at TIME [PART...]\n"
+          << "       comporg-cli [--data data.xml] usage --from TIME [--to TIME]\n"
+          << "       comporg-cli [--data data.xml] [--profiles DIR] batch [--out DIR] [--optimize] MANIFEST\n"
+          << "       comporg-cli [--data data.xml] bench [--components N]\n"
+          << "\n"
+          << "Prints one JSON object per BOM (or per SMT program) on its own line;\n"
+          << "reduce and add book all their BOMs as one kit and print one object.\n"
+          << "A batch manifest lists PCB name, BOM, place file and panel per row.\n"
+          << "reduce refuses a BOM with shortages unless --force is given.\n"
+          << "bench times the loading of data.xml or, with --components, of a\n"
+          << "generated library of N components, from XML and from the snapshot.\n";
+    err().flush();
+}
+
+static bool parseArguments(const QStringList &args, Options *options)
+{
+    options->boards = 1;
+    options->components = 0;
+    options->force = false;
+    options->optimize = false;
+
+    for(int i = 1; i < args.count(); i++)
+    {
+        QString arg = args.at(i);
+        bool hasValue = (i + 1 < args.count());
+
+        if(arg == "--data" && hasValue)
+            options->dataPath = args.at(++i);
+        else if(arg == "--profiles" && hasValue)
+            options->profilePath = args.at(++i);
+        else if(arg == "--boards" && hasValue)
+        {
+            bool ok;
+            options->boards = args.at(++i).toInt(&ok);
+            if(!ok || options->boards <= 0)
+                return false;
+        }
+        else if(arg == "--components" && hasValue)
+        {
+            bool ok;
+            options->components = args.at(++i).toInt(&ok);
+            if(!ok || options->components <= 0)
+                return false;
+        }
+        else if(arg == "--force")
+            options->force = true;
+        else if(arg == "--optimize")
+            options->optimize = true;
+        else if(arg == "--panel" && hasValue)
+            options->panel = args.at(++i);
+        else if((arg == "--at" || arg == "--from" || arg == "--to") && hasValue)
+        {
+            QDateTime time = QDateTime::fromString(args.at(++i), Qt::ISODate);
+            if(!time.isValid())
+                return false;
+            if(arg == "--at")
+                options->at = time;
+            else if(arg == "--from")
+                options->from = time;
+            else
+                options->to = time;
+        }
+        else if(arg == "--pcb" && hasValue)
+            options->pcbName = args.at(++i);
+        else if(arg == "--place" && hasValue)
+            options->placePath = args.at(++i);
+        else if(arg == "--bom" && hasValue)
+            options->bomPath = args.at(++i);
+        else if(arg == "--out" && hasValue)
+            options->outPath = args.at(++i);
+        else if(arg.startsWith("--"))
+            return false;
+        else if(options->command.isEmpty())
+            options->command = arg;
+        else
+            options->files.append(arg);
+    }
+
+    if(options->command == "smt")
+        return !options->pcbName.isEmpty() && !options->placePath.isEmpty() && options->files.isEmpty();
+    if(options->command == "batch")
+        return options->files.count() == 1;
+    if(options->command == "history")
+        return options->at.isValid();
+    if(options->command == "usage")
+        return options->from.isValid() && options->files.isEmpty();
+    if(options->command == "bench")
+        return options->files.isEmpty();
+
+    QStringList bomCommands;
+    bomCommands << "check" << "reduce" << "add" << "max" << "plan";
+    return bomCommands.contains(options->command) && !options->files.isEmpty();
+}
+
+static void writeShortages(JsonWriter &json, const QList<Bom::Shortage> &shortages)
+{
+    json.beginArray("shortages");
+    foreach(const Bom::Shortage &s, shortages)
+    {
+        json.beginObject();
+        json.value("part", s.partNumber);
+        json.value("designators", s.designators);
+        json.value("missing", s.missing);
+        json.value("required", s.required);
+        json.value("available", s.available);
+        json.endObject();
+    }
+    json.endArray();
+}
+
+// Books every BOM of a reduce or add command as one kit: all of it or,
+// when a file cannot be read or stock runs short, none of it
+static bool runKitCommand(CO *co, const Options &options)
+{
+    JsonWriter json;
+    json.beginObject();
+    json.value("command", options.command);
+    json.value("boms", options.files);
+    json.value("boards", options.boards);
+
+    StockReservation reservation(co);
+    QStringList names;
+    foreach(const QString &filePath, options.files)
+        names.append(QFileInfo(filePath).fileName());
+    reservation.setReference(names.join(", "));
+    int boards = (options.command == "reduce") ? -options.boards : options.boards;
+    bool ok = true;
+
+    foreach(const QString &filePath, options.files)
+    {
+        Bom bom;
+        if(!bom.load(filePath))
+        {
+            json.value("error", bom.errorString());
+            ok = false;
+            break;
+        }
+        reservation.addBom(bom, boards);
+    }
+
+    if(ok)
+    {
+        if(options.command == "reduce")
+            writeShortages(json, reservation.shortages());
+
+        // Nothing can run short when adding; missing parts are skipped
+        ok = reservation.commit(options.force || options.command == "add");
+        if(ok)
+            json.value("skipped", reservation.skipped());
+        else
+            json.value("error", reservation.errorString());
+    }
+
+    json.value("ok", ok);
+    json.endObject();
+    out() << json.toString() << '\n';
+    return ok;
+}
+
+// Adds up the demand of several products, each BOM built the number of
+// times given after its name (or --boards), and lists what must be bought
+static bool runPlanCommand(CO *co, const Options &options)
+{
+    JsonWriter json;
+    json.beginObject();
+    json.value("command", options.command);
+
+    ShortagePlanner planner(co);
+    QRegExp withBoards("(.+):(\\d+)");
+    bool ok = true;
+
+    foreach(const QString &arg, options.files)
+    {
+        QString filePath = arg;
+        int boards = options.boards;
+        if(withBoards.exactMatch(arg) && !QFileInfo(arg).exists())
+        {
+            filePath = withBoards.cap(1);
+            boards = withBoards.cap(2).toInt();
+        }
+
+        Bom bom;
+        if(!bom.load(filePath))
+        {
+            json.value("bom", filePath);
+            json.value("error", bom.errorString());
+            ok = false;
+            break;
+        }
+        planner.addBom(bom, boards, QFileInfo(filePath).completeBaseName());
+    }
+
+    if(ok)
+    {
+        QList<ShortagePlanner::Demand> purchase = planner.purchaseList();
+
+        json.value("products", planner.productCount());
+        json.beginArray("purchase");
+        foreach(const ShortagePlanner::Demand &d, purchase)
+        {
+            json.beginObject();
+            json.value("part", d.partNumber);
+            json.value("required", d.required);
+            json.value("available", d.available);
+            json.value("toBuy", d.toBuy());
+            json.value("missing", d.missing);
+            json.value("products", d.products);
+            json.endObject();
+        }
+        json.endArray();
+
+        if(!options.outPath.isEmpty())
+        {
+            if(ShortagePlanner::writeCsv(options.outPath, purchase))
+                json.value("output", options.outPath);
+            else
+            {
+                json.value("error", QString("cannot write ") + options.outPath);
+                ok = false;
+            }
+        }
+    }
+
+    json.value("ok", ok);
+    json.endObject();
+    out() << json.toString() << '\n';
+    return ok;
+}
+
+// Stock of the given parts (all when none is given) at a past time,
+// worked out from the stock ledger, one line per part and package
+static bool runHistoryCommand(CO *co, const Options &options)
+{
+    QList<Component *> components;
+    bool ok = true;
+
+    if(options.files.isEmpty())
+        components = co->components();
+    foreach(const QString &partNumber, options.files)
+    {
+        Component *c = co->findComponent(partNumber);
+        if(c)
+            components.append(c);
+        else
+        {
+            JsonWriter json;
+            json.beginObject();
+            json.value("command", options.command);
+            json.value("part", partNumber);
+            json.value("error", "not in the library");
+            json.value("ok", false);
+            json.endObject();
+            out() << json.toString() << '\n';
+            ok = false;
+        }
+    }
+
+    foreach(Component *c, components)
+        foreach(const Stock &s, c->stocks())
+        {
+            JsonWriter json;
+            json.beginObject();
+            json.value("command", options.command);
+            json.value("part", c->name());
+            json.value("package", s.package()->name());
+            json.value("at", options.at.toString(Qt::ISODate));
+            json.value("stock", co->stockAt(c, s, options.at));
+            json.value("now", s.stock());
+            json.value("ok", true);
+            json.endObject();
+            out() << json.toString() << '\n';
+        }
+
+    return ok;
+}
+
+// Stock movements per part and package between two times, with the
+// average daily consumption by BOM kits
+static bool runUsageCommand(CO *co, const Options &options)
+{
+    QDateTime to = options.to.isValid() ? options.to : QDateTime::currentDateTime();
+    double days = qMax(options.from.secsTo(to) / 86400.0, 1.0);
+
+    foreach(const StockLedger::Usage &u, co->stockLedger().usage(options.from, to))
+    {
+        JsonWriter json;
+        json.beginObject();
+        json.value("command", options.command);
+        json.value("part", u.component);
+        json.value("package", u.package);
+        json.value("consumed", (int)u.consumed);
+        json.value("net", (int)u.net);
+        json.value("perDay", u.consumed / days);
+        json.endObject();
+        out() << json.toString() << '\n';
+    }
+
+    return true;
+}
+
+// Runs a BOM command on one file; returns false if it failed
+static bool runBomCommand(CO *co, const Options &options, const QString &filePath)
+{
+    JsonWriter json;
+    json.beginObject();
+    json.value("command", options.command);
+    json.value("bom", filePath);
+
+    Bom bom;
+    bool ok = bom.load(filePath);
+
+    if(!ok)
+        json.value("error", bom.errorString());
+    else if(options.command == "max")
+    {
+        QString limitingPart;
+        json.value("maximum", bom.maximumBuildable(co, &limitingPart));
+        json.value("limitingPart", limitingPart);
+    }
+    else
+    {
+        json.value("boards", options.boards);
+
+        QList<Bom::Shortage> shortages = bom.shortages(co, options.boards);
+        writeShortages(json, shortages);
+        json.value("enoughStock", shortages.isEmpty());
+    }
+
+    json.value("ok", ok);
+    json.endObject();
+    out() << json.toString() << '\n';
+    return ok;
+}
+
+static bool runSmtCommand(SmtProfileLibrary *library, const Options &options)
+{
+    SmtProgram program(library);
+    program.setOptimizeSequence(options.optimize);
+    QString outPath = options.outPath.isEmpty() ? options.pcbName + ".txt" : options.outPath;
+
+    JsonWriter json;
+    json.beginObject();
+    json.value("command", options.command);
+    json.value("place", options.placePath);
+    if(!options.bomPath.isEmpty())
+        json.value("bom", options.bomPath);
+
+    SmtPanel panel;
+    QString error;
+    bool ok = panel.parse(options.panel, &error);
+    if(ok)
+    {
+        program.setPanel(panel);
+        ok = program.generate(options.pcbName, options.placePath, options.bomPath);
+        error = program.errorString();
+    }
+
+    if(!ok)
+        json.value("error", error);
+    else if(!program.save(outPath))
+    {
+        json.value("error", QString("cannot write ") + outPath);
+        ok = false;
+    }
+    else
+    {
+        json.value("output", outPath);
+        json.value("boards", panel.boardCount());
+        json.value("placements", program.placements().count());
+        json.value("profiles", program.profileNames());
+
+        const SmtHeadScheduler &schedule = program.headSchedule();
+        json.beginArray("heads");
+        for(int h = 0; h < SmtHeadScheduler::HeadCount; h++)
+            json.value(QString(), schedule.load(h));
+        json.endArray();
+        json.value("busiestHead", schedule.maximumLoad());
+        json.value("roundRobinBusiestHead", schedule.roundRobinMaximumLoad());
+        json.value("balance", schedule.balance());
+        json.value("travelBefore", program.travelBefore());
+        json.value("travelAfter", program.travelAfter());
+    }
+
+    json.value("ok", ok);
+    json.endObject();
+    out() << json.toString() << '\n';
+    return ok;
+}
+
+static bool runBatchCommand(SmtProfileLibrary *library, const Options &options)
+{
+    QString manifestPath = options.files.first();
+    QString outputDir = options.outPath.isEmpty() ? QFileInfo(manifestPath).absolutePath() : options.outPath;
+
+    SmtBatch batch(library);
+    batch.setOptimizeSequence(options.optimize);
+
+    bool ok = batch.loadManifest(manifestPath);
+    if(ok)
+    {
+        ok = batch.run(outputDir);
+
+        foreach(const SmtBatch::Job &job, batch.jobs())
+        {
+            JsonWriter json;
+            json.beginObject();
+            json.value("command", options.command);
+            json.value("pcb", job.pcbName);
+            json.value("place", job.placePath);
+            if(!job.bomPath.isEmpty())
+                json.value("bom", job.bomPath);
+            if(job.ok)
+            {
+                json.value("output", job.outputPath);
+                json.value("boards", job.boards);
+                json.value("placements", job.placements);
+                json.value("profiles", job.profiles);
+                json.value("busiestHead", job.busiestHead);
+                json.value("balance", job.balance);
+                json.value("travelBefore", job.travelBefore);
+                json.value("travelAfter", job.travelAfter);
+            }
+            else
+                json.value("error", job.errorString);
+            json.value("ok", job.ok);
+            json.endObject();
+            out() << json.toString() << '\n';
+        }
+    }
+
+    JsonWriter json;
+    json.beginObject();
+    json.value("command", options.command);
+    json.value("manifest", manifestPath);
+    if(!batch.errorString().isEmpty())
+        json.value("error", batch.errorString());
+    if(!batch.summaryPath().isEmpty())
+        json.value("summary", batch.summaryPath());
+    json.value("programs", batch.jobs().count());
+    json.value("ok", ok);
+    json.endObject();
+    out() << json.toString() << '\n';
+    return ok;
+}
+
+// Resident memory of the process in bytes, -1 where it cannot be read
+static double residentBytes()
+{
+#ifdef __linux__
+    QFile file("/proc/self/statm");
+    if(file.open(QIODevice::ReadOnly))
+    {
+        QList<QByteArray> fields = file.readAll().split(' ');
+        if(fields.count() > 1)
+            return fields.at(1).toDouble() * sysconf(_SC_PAGESIZE);
+    }
+#endif
+    return -1;
+}
+
+// A library of 'count' components in the format written by CO::writeXML(),
+// each with one or two datasheets and stocks, a container and two labels
+static bool writeBenchLibrary(const QString &filePath, int count)
+{
+    const int manufacturers = 20, packages = 30, containers = 50, topLabels = 10, leafs = 8;
+
+    QFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QXmlStreamWriter stream(&file);
+    stream.setAutoFormatting(true);
+    stream.writeStartDocument();
+    stream.writeStartElement("comporg");
+    stream.writeAttribute("version", CO_VERSION);
+    stream.writeAttribute("journal", "0");
+
+    stream.writeStartElement("manufacturers");
+    stream.writeAttribute("n", QString::number(manufacturers));
+    for(int i = 0; i < manufacturers; i++)
+    {
+        stream.writeStartElement("manufacturer");
+        stream.writeAttribute("name", QString("Manufacturer %1").arg(i));
+        stream.writeEndElement();
+    }
+    stream.writeEndElement(); // </manufacturers>
+
+    stream.writeStartElement("packages");
+    stream.writeAttribute("n", QString::number(packages));
+    for(int i = 0; i < packages; i++)
+    {
+        stream.writeStartElement("package");
+        stream.writeAttribute("name", QString("PKG%1").arg(i));
+        stream.writeEndElement();
+    }
+    stream.writeEndElement(); // </packages>
+
+    stream.writeStartElement("containers");
+    stream.writeAttribute("n", QString::number(containers));
+    for(int i = 0; i < containers; i++)
+    {
+        stream.writeStartElement("container");
+        stream.writeAttribute("name", QString("Box %1").arg(i));
+        stream.writeEndElement();
+    }
+    stream.writeEndElement(); // </containers>
+
+    stream.writeStartElement("labels");
+    stream.writeAttribute("ntop", QString::number(topLabels));
+    stream.writeAttribute("levels", "2");
+    for(int i = 0; i < topLabels; i++)
+    {
+        stream.writeStartElement("label");
+        stream.writeAttribute("name", QString("Label %1").arg(i));
+        stream.writeAttribute("leafs", QString::number(leafs));
+        for(int j = 0; j < leafs; j++)
+        {
+            stream.writeStartElement("label");
+            stream.writeAttribute("name", QString("Label %1.%2").arg(i).arg(j));
+            stream.writeAttribute("leafs", "0");
+            stream.writeEndElement();
+        }
+        stream.writeEndElement();
+    }
+    stream.writeEndElement(); // </labels>
+
+    stream.writeStartElement("components");
+    stream.writeAttribute("n", QString::number(count));
+    for(int i = 0; i < count; i++)
+    {
+        int top = i % topLabels;
+        int datasheets = 1 + i % 2;
+        int stocks = 1 + (i / 2) % 2;
+
+        stream.writeStartElement("component");
+        stream.writeAttribute("name", QString("BENCH-%1").arg(i, 6, 10, QChar('0')));
+        stream.writeTextElement("description", QString("Generated part %1, 100nF 50V X7R").arg(i));
+
+        stream.writeStartElement("datasheets");
+        stream.writeAttribute("n", QString::number(datasheets));
+        stream.writeAttribute("default", "0");
+        stream.writeAttribute("link", "");
+        for(int j = 0; j < datasheets; j++)
+        {
+            stream.writeStartElement("datasheet");
+            stream.writeAttribute("type", Datasheet::typeToString(j == 0 ? Datasheet::Normal : Datasheet::Errata));
+            stream.writeAttribute("manufacturer", QString("Manufacturer %1").arg((i + j) % manufacturers));
+            stream.writeAttribute("path", QString("datasheets/bench-%1-%2.pdf").arg(i).arg(j));
+            stream.writeEndElement();
+        }
+        stream.writeEndElement(); // </datasheets>
+
+        stream.writeStartElement("stocks");
+        stream.writeAttribute("n", QString::number(stocks));
+        stream.writeAttribute("ignore", "false");
+        for(int j = 0; j < stocks; j++)
+        {
+            stream.writeStartElement("stock");
+            stream.writeAttribute("package", QString("PKG%1").arg((i + j) % packages));
+            stream.writeAttribute("value", QString::number(i % 5000));
+            stream.writeAttribute("low", "100");
+            stream.writeEndElement();
+        }
+        stream.writeEndElement(); // </stocks>
+
+        stream.writeStartElement("container");
+        stream.writeAttribute("name", QString("Box %1").arg(i % containers));
+        stream.writeEndElement();
+
+        stream.writeStartElement("labels");
+        stream.writeAttribute("n", "2");
+        stream.writeStartElement("label");
+        stream.writeAttribute("level", "0");
+        stream.writeAttribute("name", QString("Label %1").arg(top));
+        stream.writeEndElement();
+        stream.writeStartElement("label");
+        stream.writeAttribute("level", "1");
+        stream.writeAttribute("name", QString("Label %1.%2").arg(top).arg(i % leafs));
+        stream.writeEndElement();
+        stream.writeEndElement(); // </labels>
+
+        stream.writeTextElement("notes", (i % 4 == 0) ? QString("Reel %1").arg(i) : QString());
+        stream.writeEndElement(); // </component>
+    }
+    stream.writeEndElement(); // </components>
+
+    stream.writeStartElement("appnotes");
+    stream.writeAttribute("n", "0");
+    stream.writeEndElement();
+
+    stream.writeEndElement(); // </comporg>
+    stream.writeEndDocument();
+
+    return !stream.hasError() && file.error() == QFile::NoError;
+}
+
+// Loads 'filePath' into 'co' and prints the time taken and the memory the
+// loaded library holds. 'co' is left loaded, so that a later load measures
+// its own growth rather than reusing memory freed by this one.
+static bool benchLoad(CO *co, const QString &filePath)
+{
+    JsonWriter json;
+    json.beginObject();
+    json.value("command", "bench");
+    json.value("data", QDir::toNativeSeparators(filePath));
+
+    double before = residentBytes();
+    bool ok = co->readXML(filePath);
+    double after = residentBytes();
+
+    if(ok)
+    {
+        CO::LoadStats stats = co->loadStats();
+        double resident = (before < 0 || after < 0) ? -1 : after - before;
+
+        json.value("source", stats.fromSnapshot ? "snapshot" : "xml");
+        json.value("ms", (double)stats.elapsed);
+        json.value("components", stats.components);
+        json.value("applicationNotes", stats.applicationNotes);
+        json.value("journalRecords", stats.journalRecords);
+        json.value("residentBytes", resident);
+        if(resident >= 0 && stats.components > 0)
+            json.value("bytesPerComponent", resident / stats.components);
+    }
+    else
+        json.value("error", QString("cannot read ") + QDir::toNativeSeparators(filePath));
+
+    json.value("ok", ok);
+    json.endObject();
+    out() << json.toString() << '\n';
+    out().flush();
+    return ok;
+}
+
+// Without --components, times one load of the data file as it is: from
+// the snapshot when it is up to date. With it, a generated library is
+// loaded twice from a scratch directory, first from XML (which writes the
+// snapshot) and then from the snapshot.
+static bool runBenchCommand(const Options &options)
+{
+    if(options.components <= 0)
+    {
+        CO co;
+        return benchLoad(&co, options.dataPath);
+    }
+
+    QString dirPath = QDir::temp().absoluteFilePath(
+                QString("comporg-bench-%1").arg(QCoreApplication::applicationPid()));
+    QString filePath = dirPath + "/data.xml";
+    QDir().mkpath(dirPath);
+
+    bool ok = writeBenchLibrary(filePath, options.components);
+    if(!ok)
+    {
+        JsonWriter json;
+        json.beginObject();
+        json.value("command", options.command);
+        json.value("error", QString("cannot write ") + QDir::toNativeSeparators(filePath));
+        json.value("ok", false);
+        json.endObject();
+        out() << json.toString() << '\n';
+    }
+    else
+    {
+        CO fromXml;
+        CO fromSnapshot;
+        ok = benchLoad(&fromXml, filePath) && benchLoad(&fromSnapshot, filePath);
+    }
+
+    QFile::remove(filePath);
+    QFile::remove(filePath + CO_SNAPSHOT_SUFFIX);
+    QFile::remove(filePath + CO_JOURNAL_SUFFIX);
+    QFile::remove(filePath + CO_LEDGER_SUFFIX);
+    QDir().rmdir(dirPath);
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    a.setOrganizationName("3xdigital");
+    a.setOrganizationDomain("3xdigital.com");
+    a.setApplicationName("Component Organizer");
+
+    out().setCodec(QTextCodec::codecForName("UTF-8"));
+
+    Options options;
+    if(!parseArguments(a.arguments(), &options))
+    {
+        usage();
+        return ExitUsage;
+    }
+
+    CO co;
+    if(options.dataPath.isEmpty())
+        options.dataPath = co.dirPath() + CO_XML_PATH;
+    if(options.profilePath.isEmpty())
+        options.profilePath = QFileInfo(options.dataPath).absolutePath() + "/profiles";
+
+    if(options.command == "smt")
+    {
+        SmtProfileLibrary library(options.profilePath);
+        return runSmtCommand(&library, options) ? ExitOk : ExitFailed;
+    }
+    if(options.command == "batch")
+    {
+        SmtProfileLibrary library(options.profilePath);
+        return runBatchCommand(&library, options) ? ExitOk : ExitFailed;
+    }
+    if(options.command == "bench")
+        return runBenchCommand(options) ? ExitOk : ExitFailed;
+
+    if(!co.readXML(options.dataPath))
+    {
+        JsonWriter json;
+        json.beginObject();
+        json.value("command", options.command);
+        json.value("error", QString("cannot read ") + QDir::toNativeSeparators(options.dataPath));
+        json.value("ok", false);
+        json.endObject();
+        out() << json.toString() << '\n';
+        return ExitFailed;
+    }
+
+    // A kit saves its stock moves itself, when committed
+    if(options.command == "reduce" || options.command == "add")
+        return runKitCommand(&co, options) ? ExitOk : ExitFailed;
+    if(options.command == "plan")
+        return runPlanCommand(&co, options) ? ExitOk : ExitFailed;
+    if(options.command == "history")
+        return runHistoryCommand(&co, options) ? ExitOk : ExitFailed;
+    if(options.command == "usage")
+        return runUsageCommand(&co, options) ? ExitOk : ExitFailed;
+
+    int result = ExitOk;
+    foreach(const QString &filePath, options.files)
+        if(!runBomCommand(&co, options, filePath))
+            result = ExitFailed;
+
+    return result;
+}
@@ -18,8 +18,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "applicationnote.h"
 
+int ApplicationNote::nextID = 0;
+
 ApplicationNote::ApplicationNote(const QString description, QObject *parent) :
     QObject(parent),
+    m_ID(ApplicationNote::nextID++),
     m_description(description)
 {
 }
+
+void ApplicationNote::setDescription(const QString &description)
+{
+    if(m_description == description)
+        return;
+
+    QString oldDescription = m_description;
+    m_description = description;
+    emit renamed(this, oldDescription);
+}
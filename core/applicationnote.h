@@ -27,10 +27,12 @@ class ApplicationNote : public QObject
 public:
     explicit ApplicationNote(const QString description, QObject *parent = 0);
 
-    void setDescription(const QString &description)
+    int ID()
     {
-        m_description = description;
+        return m_ID;
     }
+
+    void setDescription(const QString &description);
     QString description()
     {
         return m_description;
@@ -64,10 +66,14 @@ public:
     }
 
 signals:
+    void renamed(ApplicationNote *appnote, const QString &oldDescription);
 
 public slots:
 
 private:
+    static int nextID;
+
+    int m_ID;
     QString m_description;
     QString m_name;
     QString m_pdfPath;
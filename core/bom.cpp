@@ -0,0 +1,157 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "bom.h"
+#include "spreadsheet.h"
+#include "co.h"
+#include "component.h"
+#include "package.h"
+#include "stock.h"
+
+#include <limits.h>
+
+Bom::Bom()
+{
+}
+
+bool Bom::load(const QString &filePath)
+{
+    SpreadSheet sheet;
+
+    m_errorString.clear();
+
+    if(!sheet.load(filePath))
+    {
+        m_errorString = sheet.errorString();
+        m_lines.clear();
+        m_lineIndex.clear();
+        return false;
+    }
+
+    read(sheet);
+    return true;
+}
+
+void Bom::read(const SpreadSheet &sheet)
+{
+    m_lines.clear();
+    m_lineIndex.clear();
+
+    // Row 1 is the header, the list ends at the first empty row
+    for(int row = 2; row <= sheet.rowCount(); row++)
+    {
+        QString partNumber = sheet.cell(row, 1);
+        int quantity = sheet.intCell(row, 2);
+        QString designators = sheet.cell(row, 3);
+
+        if(partNumber == "" && quantity == 0 && designators == "")
+            break;
+
+        int index = m_lineIndex.value(partNumber, -1);
+        if(index < 0)
+        {
+            Line line;
+            line.partNumber = partNumber;
+            line.quantity = quantity;
+            line.designators = designators;
+            m_lineIndex.insert(partNumber, m_lines.count());
+            m_lines.append(line);
+        }
+        else
+        {
+            Line &line = m_lines[index];
+            line.quantity += quantity;
+            if(!designators.isEmpty())
+                line.designators += line.designators.isEmpty() ? designators : ", " + designators;
+        }
+    }
+}
+
+// Number of complete boards the current stock can supply, i.e. the minimum
+// of stock / quantity over every line. limitingPart receives the part that
+// runs out first.
+int Bom::maximumBuildable(CO *co, QString *limitingPart) const
+{
+    int maximum = INT_MAX;
+    QString limiting;
+
+    foreach(const Line &line, m_lines)
+    {
+        if(line.quantity <= 0)
+            continue;
+
+        Component *c = co->findComponent(line.partNumber);
+        int available = 0;
+        if(c)
+        {
+            Stock *s = bomStock(c);
+            if(s)
+                available = qMax(s->stock(), 0);
+        }
+
+        int boards = available / line.quantity;
+        if(boards < maximum)
+        {
+            maximum = boards;
+            limiting = line.partNumber;
+        }
+    }
+
+    if(maximum == INT_MAX)
+        maximum = 0;
+
+    if(limitingPart)
+        *limitingPart = limiting;
+
+    return maximum;
+}
+
+QList<Bom::Shortage> Bom::shortages(CO *co, int boards) const
+{
+    QList<Shortage> list;
+
+    foreach(const Line &line, m_lines)
+    {
+        Shortage shortage;
+        shortage.partNumber = line.partNumber;
+        shortage.designators = line.designators;
+        shortage.required = line.quantity * boards;
+        shortage.available = 0;
+
+        Component *c = co->findComponent(line.partNumber);
+        shortage.missing = (c == 0);
+        if(c)
+        {
+            Stock *s = bomStock(c);
+            if(s)
+                shortage.available = s->stock();
+        }
+
+        if(shortage.missing || shortage.available == 0 || shortage.available < shortage.required)
+            list.append(shortage);
+    }
+
+    return list;
+}
+
+// BOM quantities are booked against the component's first stock, taken in
+// the order packages are listed in the options
+Stock *Bom::bomStock(Component *component)
+{
+    return component->bookingStock();
+}
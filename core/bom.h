@@ -0,0 +1,87 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef BOM_H
+#define BOM_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+
+class CO;
+class Component;
+class Stock;
+class SpreadSheet;
+
+// Bill of materials read once from a BOM sheet (A = Erp code, B = quantity,
+// C = designators). Rows naming the same part are merged, so stock can be
+// checked against the whole board in a single pass.
+class Bom
+{
+    Q_DECLARE_TR_FUNCTIONS(Bom)
+
+public:
+    struct Line
+    {
+        QString partNumber;
+        int quantity;           // per board
+        QString designators;
+    };
+
+    struct Shortage
+    {
+        QString partNumber;
+        QString designators;
+        bool missing;           // part not in the library
+        int required;
+        int available;
+    };
+
+    Bom();
+
+    bool load(const QString &filePath);
+    void read(const SpreadSheet &sheet);
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+    bool isEmpty() const
+    {
+        return m_lines.isEmpty();
+    }
+    QList<Line> lines() const
+    {
+        return m_lines;
+    }
+
+    int maximumBuildable(CO *co, QString *limitingPart = 0) const;
+    QList<Shortage> shortages(CO *co, int boards) const;
+
+    static Stock *bomStock(Component *component);
+
+private:
+    QList<Line> m_lines;
+    QHash<QString, int> m_lineIndex;
+    QString m_errorString;
+};
+
+#endif // BOM_H
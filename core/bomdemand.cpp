@@ -0,0 +1,61 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "bomdemand.h"
+#include "bom.h"
+#include "co.h"
+
+BomDemand::BomDemand(CO *co) :
+    m_co(co)
+{
+}
+
+// Adds the lines of 'boards' boards; a negative count takes them out.
+// 'product', when given, is listed once per run of lines of that product.
+void BomDemand::addBom(const Bom &bom, int boards, const QString &product)
+{
+    foreach(const Bom::Line &line, bom.lines())
+    {
+        int index = m_partIndex.value(line.partNumber, -1);
+        if(index < 0)
+        {
+            Part part;
+            part.partNumber = line.partNumber;
+            part.component = m_co->findComponent(line.partNumber);
+            part.stock = (part.component != 0) ? Bom::bomStock(part.component) : 0;
+            part.quantity = 0;
+
+            index = m_parts.count();
+            m_partIndex.insert(line.partNumber, index);
+            m_parts.append(part);
+        }
+
+        Part &part = m_parts[index];
+        part.quantity += line.quantity * boards;
+        if(!line.designators.isEmpty())
+            part.designators += part.designators.isEmpty() ? line.designators : ", " + line.designators;
+        if(!product.isEmpty() && (part.products.isEmpty() || part.products.last() != product))
+            part.products.append(product);
+    }
+}
+
+void BomDemand::clear()
+{
+    m_parts.clear();
+    m_partIndex.clear();
+}
@@ -0,0 +1,69 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef BOMDEMAND_H
+#define BOMDEMAND_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+
+class CO;
+class Bom;
+class Component;
+class Stock;
+
+// Lines of several BOMs added up per part, each part looked up in the
+// library once, when it first shows up. A part used by several BOMs is
+// then checked against its total. Used by StockReservation for kits and
+// by ShortagePlanner for build plans.
+class BomDemand
+{
+public:
+    struct Part
+    {
+        QString partNumber;
+        QString designators;    // of every BOM, comma separated
+        QStringList products;   // products using the part, in order of addition
+        Component *component;   // 0 when not in the library
+        Stock *stock;           // stock BOMs are booked against, 0 if none
+        int quantity;           // sum of quantity * boards
+    };
+
+    explicit BomDemand(CO *co);
+
+    void addBom(const Bom &bom, int boards, const QString &product = QString());
+    void clear();
+
+    bool isEmpty() const
+    {
+        return m_parts.isEmpty();
+    }
+    QList<Part> parts() const
+    {
+        return m_parts;
+    }
+
+private:
+    CO *m_co;
+    QList<Part> m_parts;
+    QHash<QString, int> m_partIndex;
+};
+
+#endif // BOMDEMAND_H
@@ -26,6 +26,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "container.h"
 #include "label.h"
 #include "stock.h"
+#include "snapshot.h"
+#include "xmlnames.h"
 
 #include <QApplication>
 #include <QDesktopServices>
@@ -36,10 +38,22 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QXmlStreamWriter>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 
 CO::CO(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    m_componentIndexBuilt(false),
+    m_appnoteIndexBuilt(false),
+    m_generation(0),
+    m_loading(false),
+    m_compactPending(true)
 {
+    m_loadStats.elapsed = 0;
+    m_loadStats.fromSnapshot = false;
+    m_loadStats.components = 0;
+    m_loadStats.applicationNotes = 0;
+    m_loadStats.journalRecords = 0;
+
 #ifdef __linux__
     QDir().mkdir(QDir::homePath() + "/.Component-Organizer");
     QDir().mkdir(QDir::homePath() + "/.Component-Organizer/fakeplace");
@@ -47,6 +61,21 @@ CO::CO(QObject *parent) :
 #else
     m_dirPath = QApplication::applicationDirPath();
 #endif
+
+    m_profileLibrary.setDirectory(m_dirPath + CO_SMT_PROFILE_PATH);
+}
+
+// The catalog entries are plain objects, owned by CO
+CO::~CO()
+{
+    qDeleteAll(m_components);
+    qDeleteAll(m_appnotes);
+    foreach(Label *top, m_topLabels)
+        qDeleteAll(top->leafs());
+    qDeleteAll(m_topLabels);
+    qDeleteAll(m_manufacturers);
+    qDeleteAll(m_packages);
+    qDeleteAll(m_containers);
 }
 
 void CO::useDefaultData()
@@ -55,11 +84,11 @@ void CO::useDefaultData()
 
     // Default manufacturers
     foreach(QString name, Manufacturer::defaultNames())
-        m_manufacturers.append(new Manufacturer(name, this));
+        addManufacturer(new Manufacturer(name));
 
     // Default packages
     foreach(QString name, Package::defaultNames())
-        m_packages.append(new Package(name, this));
+        addPackage(new Package(name));
 
     // Default labels
     Label *top;
@@ -69,7 +98,7 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("MOS"), top));
     top->addLeaf(new Label(tr("JFET"), top));
     top->addLeaf(new Label(tr("IGBT"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Diode"));
     top->addLeaf(new Label(tr("Fast Recovery"), top));
@@ -82,7 +111,7 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("TRIAC"), top));
     top->addLeaf(new Label(tr("DIAC"), top));
     top->addLeaf(new Label(tr("Varicap"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Resistor"));
     top->addLeaf(new Label(tr("Carbon Film"), top));
@@ -92,7 +121,7 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("Common Pin Network"), top));
     top->addLeaf(new Label(tr("Isolated Network"), top));
     top->addLeaf(new Label(tr("Varistor"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Capacitor"));
     top->addLeaf(new Label(tr("Ceramic"), top));
@@ -110,27 +139,27 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("Glass"), top));
     top->addLeaf(new Label(tr("Paper"), top));
     top->addLeaf(new Label(tr("Metalized Paper"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Inductor"));
     top->addLeaf(new Label(tr("Common Inductor"), top));
     top->addLeaf(new Label(tr("Power Inductor"), top));
     top->addLeaf(new Label(tr("RF"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Optoelectronic"));
     top->addLeaf(new Label(tr("lamp"), top));
     top->addLeaf(new Label(tr("LED"), top));
     top->addLeaf(new Label(tr("Laser"), top));
     top->addLeaf(new Label(tr("Optocoupler"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Display"));
     top->addLeaf(new Label(tr("OLED"), top));
     top->addLeaf(new Label(tr("LCD"), top));
     top->addLeaf(new Label(tr("7-Segment"), top));
     top->addLeaf(new Label(tr("Bar graph"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Microcontroller"));
     top->addLeaf(new Label(tr("PIC"), top));
@@ -138,7 +167,7 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("ATtiny"), top));
     top->addLeaf(new Label(tr("MSP430"), top));
     top->addLeaf(new Label(tr("ARM"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Sensor"));
     top->addLeaf(new Label(tr("Accelerometer"), top));
@@ -148,12 +177,12 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("Pressure"), top));
     top->addLeaf(new Label(tr("Light"), top));
     top->addLeaf(new Label(tr("Current"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Data Converter"));
     top->addLeaf(new Label(tr("A/D"), top));
     top->addLeaf(new Label(tr("D/A"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Signal Conditioner"));
     top->addLeaf(new Label(tr("Op. Amp."), top));
@@ -161,7 +190,7 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("Filter"), top));
     top->addLeaf(new Label(tr("Voltage Ref"), top));
     top->addLeaf(new Label(tr("RMS-DC Converter"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Interface"));
     top->addLeaf(new Label(tr("USB"), top));
@@ -174,7 +203,7 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("SIM"), top));
     top->addLeaf(new Label(tr("CAN"), top));
     top->addLeaf(new Label(tr("Wireless/RF"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Supply"));
     top->addLeaf(new Label(tr("LDO")));
@@ -185,13 +214,13 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("LED Driver"), top));
     top->addLeaf(new Label(tr("Supply Protection"), top));
     top->addLeaf(new Label(tr("Transformer"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Memory"));
     top->addLeaf(new Label(tr("EEPROM"), top));
     top->addLeaf(new Label(tr("SRAM"), top));
     top->addLeaf(new Label(tr("FLASH"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Relay"));
     top->addLeaf(new Label(tr("Power Relay"), top));
@@ -199,7 +228,7 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("Solid State"), top));
     top->addLeaf(new Label(tr("High Frequency"), top));
     top->addLeaf(new Label(tr("Analog Switch"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Switch"));
     top->addLeaf(new Label(tr("Slide"), top));
@@ -207,7 +236,7 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("Rocker"), top));
     top->addLeaf(new Label(tr("Momentary Push"), top));
     top->addLeaf(new Label(tr("Push-lock"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Connector"));
     top->addLeaf(new Label(tr("I/O connector"), top));
@@ -215,50 +244,445 @@ void CO::useDefaultData()
     top->addLeaf(new Label(tr("Ribbon"), top));
     top->addLeaf(new Label(tr("Header"), top));
     top->addLeaf(new Label(tr("Screw Terminal"), top));
-    m_topLabels.append(top);
+    addTopLabel(top);
 
     top = new Label(tr("Heatsink"));
-    m_topLabels.append(top);
+    addTopLabel(top);
 }
 
 void CO::addManufacturer(Manufacturer *manufacturer)
 {
     m_manufacturers.append(manufacturer);
+    if(!m_manufacturerByName.contains(manufacturer->name()))
+        m_manufacturerByName.insert(manufacturer->name(), manufacturer);
+    catalogChanged();
 }
 
 void CO::addPackage(Package *package)
 {
     m_packages.append(package);
+    if(!m_packageByName.contains(package->name()))
+        m_packageByName.insert(package->name(), package);
+    catalogChanged();
 }
 
 void CO::addContainer(Container *container)
 {
     m_containers.append(container);
+    if(!m_containerByName.contains(container->name()))
+        m_containerByName.insert(container->name(), container);
+    catalogChanged();
 }
 
 void CO::addTopLabel(Label *topLabel)
 {
     m_topLabels.append(topLabel);
+    if(!m_topLabelByName.contains(topLabel->name()))
+        m_topLabelByName.insert(topLabel->name(), topLabel);
+
+    indexLabel(topLabel);
+    foreach(Label *leaf, topLabel->leafs())
+        indexLabel(leaf);
+    catalogChanged();
+}
+
+void CO::addSecondaryLabel(Label *top, Label *leaf)
+{
+    leaf->setTop(top);
+    top->addLeaf(leaf);
+    indexLabel(leaf);
+    catalogChanged();
 }
 
 void CO::addComponent(Component *component)
 {
     m_components.append(component);
+    if(component->ID() >= m_componentById.size())
+        m_componentById.resize(component->ID() + 1);
+    m_componentById[component->ID()] = component;
+    component->m_owner = this;
+    if(!m_componentByName.contains(component->name()))
+        m_componentByName.insert(component->name(), component);
+
+    bucketComponent(component, component->primaryLabel(), component->secondaryLabel());
+
+    // The opening stock of a new component is its first movement
+    if(!m_loading)
+        foreach(const Stock &s, component->stocks())
+            if(s.package() != 0)
+                recordStockEdit(component, s.package()->name(), s.stock());
+
+    componentChanged(component);
 }
 
 void CO::addApplicationNote(ApplicationNote *appnote)
 {
     m_appnotes.append(appnote);
+    m_appnoteById.insert(appnote->ID(), appnote);
+    if(!m_appnoteByDescription.contains(appnote->description()))
+        m_appnoteByDescription.insert(appnote->description(), appnote);
+
+    connect(appnote, SIGNAL(renamed(ApplicationNote *, QString)),
+            this, SLOT(applicationNoteRenamed(ApplicationNote *, QString)));
+
+    applicationNoteChanged(appnote);
+}
+
+// Drops 'item' from a name index. If another object with the same name is
+// still listed, the index is pointed at it, so find*() keeps returning the
+// first match in list order.
+template <class T>
+static void unindexName(QHash<QString, T *> &index, const QList<T *> &list, T *item, const QString &name)
+{
+    if(index.value(name) != item)
+        return;
+
+    index.remove(name);
+    foreach(T *t, list)
+        if(t != item && t->name() == name)
+        {
+            index.insert(name, t);
+            return;
+        }
+}
+
+void CO::indexLabel(Label *label)
+{
+    if(!m_labelByName.contains(label->name()))
+        m_labelByName.insert(label->name(), label);
+}
+
+void CO::unindexLabel(Label *label)
+{
+    QString name = label->name();
+
+    if(m_topLabelByName.value(name) == label)
+    {
+        m_topLabelByName.remove(name);
+        foreach(Label *top, m_topLabels)
+            if(top != label && top->name() == name)
+            {
+                m_topLabelByName.insert(name, top);
+                break;
+            }
+    }
+
+    if(m_labelByName.value(name) == label)
+    {
+        m_labelByName.remove(name);
+        foreach(Label *top, m_topLabels)
+        {
+            if(top != label && top->name() == name)
+            {
+                m_labelByName.insert(name, top);
+                break;
+            }
+            Label *leaf = top->leaf(name);
+            if(leaf != 0 && leaf != label)
+            {
+                m_labelByName.insert(name, leaf);
+                break;
+            }
+        }
+    }
+}
+
+void CO::componentRenamed(Component *component, const QString &oldName)
+{
+    unindexName(m_componentByName, m_components, component, oldName);
+    if(!m_componentByName.contains(component->name()))
+        m_componentByName.insert(component->name(), component);
+
+    if(m_componentIndexBuilt)
+        indexComponent(component);
+
+    if(!m_loading)
+    {
+        m_pendingRecords.append(Journal::Record(Journal::ComponentRename,
+                                                QStringList() << oldName << component->name()));
+        m_ledger.rename(oldName, component->name());
+    }
+}
+
+void CO::bucketComponent(Component *component, Label *primary, Label *secondary)
+{
+    if(primary == 0)
+        m_unlabeledComponents.insert(component);
+    else
+        m_componentsByLabel[primary].insert(component);
+
+    if(secondary != 0)
+        m_componentsByLabel[secondary].insert(component);
+}
+
+void CO::unbucketComponent(Component *component, Label *primary, Label *secondary)
+{
+    if(primary == 0)
+        m_unlabeledComponents.remove(component);
+
+    Label *labels[2] = { primary, secondary };
+    for(int i = 0; i < 2; i++)
+    {
+        if(labels[i] == 0)
+            continue;
+
+        QHash<Label *, QSet<Component *> >::iterator b = m_componentsByLabel.find(labels[i]);
+        if(b == m_componentsByLabel.end())
+            continue;
+
+        b.value().remove(component);
+        if(b.value().isEmpty())
+            m_componentsByLabel.erase(b);
+    }
+}
+
+void CO::componentLabelsChanged(Component *component, Label *oldPrimary, Label *oldSecondary)
+{
+    unbucketComponent(component, oldPrimary, oldSecondary);
+    bucketComponent(component, component->primaryLabel(), component->secondaryLabel());
+}
+
+// Walks the smaller bucket, so the cost follows the size of the result
+QSet<Component *> CO::componentsWithLabels(Label *primary, Label *secondary)
+{
+    if(secondary == 0)
+        return componentsWithLabel(primary);
+
+    QSet<Component *> a = componentsWithLabel(primary);
+    QSet<Component *> b = componentsWithLabel(secondary);
+    if(b.count() < a.count())
+        qSwap(a, b);
+
+    QSet<Component *> both;
+    foreach(Component *c, a)
+        if(b.contains(c) && c->primaryLabel() == primary && c->secondaryLabel() == secondary)
+            both.insert(c);
+    return both;
+}
+
+void CO::applicationNoteRenamed(ApplicationNote *appnote, const QString &oldDescription)
+{
+    if(m_appnoteByDescription.value(oldDescription) == appnote)
+    {
+        m_appnoteByDescription.remove(oldDescription);
+        foreach(ApplicationNote *a, m_appnotes)
+            if(a != appnote && a->description() == oldDescription)
+            {
+                m_appnoteByDescription.insert(oldDescription, a);
+                break;
+            }
+    }
+
+    if(!m_appnoteByDescription.contains(appnote->description()))
+        m_appnoteByDescription.insert(appnote->description(), appnote);
+
+    if(m_appnoteIndexBuilt)
+        indexApplicationNote(appnote);
+
+    if(!m_loading)
+        m_pendingRecords.append(Journal::Record(Journal::ApplicationNoteRename,
+                                                QStringList() << oldDescription << appnote->description()));
+}
+
+void CO::componentChanged(Component *component)
+{
+    if(m_componentIndexBuilt)
+        indexComponent(component);
+
+    if(!m_loading)
+        m_dirtyComponents.insert(component);
+}
+
+void CO::applicationNoteChanged(ApplicationNote *appnote)
+{
+    if(m_appnoteIndexBuilt)
+        indexApplicationNote(appnote);
+
+    if(!m_loading)
+        m_dirtyAppnotes.insert(appnote);
+}
+
+// Records a stock movement without rewriting the whole component
+void CO::stockChanged(Component *component, Stock *stock, int delta)
+{
+    if(m_loading || m_dirtyComponents.contains(component))
+        return;
+
+    m_pendingRecords.append(Journal::Record(Journal::StockDelta,
+                                            QStringList() << component->name() << stock->package()->name(),
+                                            delta));
+}
+
+// Earlier edits are saved first, so the moves get a journal record of their
+// own that is replayed entirely or, when torn by a crash, not at all. The
+// ledger is written before the stock: if the stock cannot be saved the
+// moves are taken back and the ledger block cut off again.
+bool CO::moveStock(const QList<StockMove> &moves, const QString &reference, bool rollback,
+                   QString *errorString)
+{
+    if(moves.isEmpty())
+        return true;
+
+    if(!updateDataXML())
+    {
+        if(errorString)
+            *errorString = tr("Unable to save the stock");
+        return false;
+    }
+
+    QList<StockLedger::Entry> entries;
+    QDateTime now = QDateTime::currentDateTime();
+    foreach(const StockMove &m, moves)
+    {
+        StockLedger::Entry e;
+        e.time = now;
+        e.component = m.component->name();
+        e.package = m.stock->package()->name();
+        e.delta = m.delta;
+        e.reason = rollback ? StockLedger::KitRollback :
+                   (m.delta < 0) ? StockLedger::KitReduce : StockLedger::KitAdd;
+        e.reference = reference;
+        entries.append(e);
+    }
+
+    qint64 ledgerSize = m_ledger.size();
+    if(!m_ledger.append(entries))
+    {
+        if(errorString)
+            *errorString = tr("Unable to write the stock history: ") + m_ledger.errorString();
+        return false;
+    }
+
+    Journal::Record record(Journal::StockBatch, QStringList(), moves.count());
+    foreach(const StockMove &m, moves)
+    {
+        m.stock->setStock(m.stock->stock() + m.delta);
+        record.fields << m.component->name() << m.stock->package()->name() << QString::number(m.delta);
+    }
+
+    bool saved;
+    if(m_compactPending || !m_journal.isOpen() || m_journal.size() > CO_JOURNAL_MAX_SIZE)
+        saved = compactXML();
+    else
+        saved = m_journal.append(QList<Journal::Record>() << record) || compactXML();
+
+    if(!saved)
+    {
+        foreach(const StockMove &m, moves)
+            m.stock->setStock(m.stock->stock() - m.delta);
+        m_ledger.truncate(ledgerSize);
+        if(errorString)
+            *errorString = tr("Unable to save the stock");
+        return false;
+    }
+
+    return true;
+}
+
+// Stock set by hand. Only the history is written here; the new stock is
+// saved with the component.
+bool CO::recordStockEdit(Component *component, const QString &package, int delta)
+{
+    if(delta == 0)
+        return true;
+
+    StockLedger::Entry e;
+    e.time = QDateTime::currentDateTime();
+    e.component = component->name();
+    e.package = package;
+    e.delta = delta;
+    e.reason = StockLedger::Manual;
+    return m_ledger.append(QList<StockLedger::Entry>() << e);
+}
+
+// Stock at 'time': today's stock less what moved since
+int CO::stockAt(Component *component, const Stock &stock, const QDateTime &time)
+{
+    return stock.stock() - m_ledger.netChange(component->name(), stock.package()->name(), time, QDateTime());
+}
+
+void CO::catalogChanged()
+{
+    if(!m_loading)
+        m_compactPending = true;
 }
 
+void CO::indexComponent(Component *component)
+{
+    QStringList fields;
+    fields << component->name() << component->description() << component->notes();
+    foreach(Datasheet *d, component->datasheets())
+        if(d->manufacturer() != 0)
+            fields << d->manufacturer()->name();
+
+    m_componentIndex.insert(component->ID(), fields);
+}
+
+void CO::indexApplicationNote(ApplicationNote *appnote)
+{
+    m_appnoteIndex.insert(appnote->ID(), QStringList() << appnote->description() << appnote->name());
+}
+
+SearchIndex CO::componentIndex()
+{
+    if(!m_componentIndexBuilt)
+    {
+        m_componentIndex.clear();
+        foreach(Component *c, m_components)
+            indexComponent(c);
+        m_componentIndexBuilt = true;
+    }
+    return m_componentIndex;
+}
+
+SearchIndex CO::applicationNoteIndex()
+{
+    if(!m_appnoteIndexBuilt)
+    {
+        m_appnoteIndex.clear();
+        foreach(ApplicationNote *a, m_appnotes)
+            indexApplicationNote(a);
+        m_appnoteIndexBuilt = true;
+    }
+    return m_appnoteIndex;
+}
+
+QList<Component *> CO::searchComponents(const QString &text)
+{
+    QList<Component *> found;
+    foreach(int id, componentIndex().search(text))
+    {
+        Component *c = findComponent(id);
+        if(c != 0)
+            found.append(c);
+    }
+    return found;
+}
+
+QList<ApplicationNote *> CO::searchApplicationNotes(const QString &text)
+{
+    QList<ApplicationNote *> found;
+    foreach(int id, applicationNoteIndex().search(text))
+    {
+        ApplicationNote *a = m_appnoteById.value(id, 0);
+        if(a != 0)
+            found.append(a);
+    }
+    return found;
+}
 
 void CO::removeManufacturer(const QString &name)
 {
     for(int i = 0; i < m_manufacturers.count(); i++)
         if(m_manufacturers[i]->name() == name)
         {
-            delete m_manufacturers[i];
-            m_manufacturers.removeAt(i);
+            Manufacturer *m = m_manufacturers.takeAt(i);
+            unindexName(m_manufacturerByName, m_manufacturers, m, name);
+            delete m;
+            // Components matched on its name; rebuilt on the next search
+            m_componentIndexBuilt = false;
+            m_componentIndex.clear();
+            catalogChanged();
             return;
         }
 }
@@ -268,8 +692,10 @@ void CO::removePackage(const QString &name)
     for(int i = 0; i < m_packages.count(); i++)
         if(m_packages[i]->name() == name)
         {
-            delete m_packages[i];
-            m_packages.removeAt(i);
+            Package *p = m_packages.takeAt(i);
+            unindexName(m_packageByName, m_packages, p, name);
+            delete p;
+            catalogChanged();
             return;
         }
 }
@@ -285,8 +711,10 @@ void CO::removeContainer(const QString &name)
     {
         if(m_containers[i]->name() == name)
         {
-            delete m_containers[i];
-            m_containers.removeAt(i);
+            Container *c = m_containers.takeAt(i);
+            unindexName(m_containerByName, m_containers, c, name);
+            delete c;
+            catalogChanged();
             return;
         }
     }
@@ -304,11 +732,19 @@ void CO::removeLabel(const QString &name)
         else
             top->removeLeaf(label->name());
 
+        unindexLabel(label);
+        m_componentsByLabel.remove(label);
+
         if(!label->leafs().isEmpty())
             foreach(Label *leaf, label->leafs())
+            {
                 leaf->setTop(0);
+                unindexLabel(leaf);
+                m_componentsByLabel.remove(leaf);
+            }
 
         delete label;
+        catalogChanged();
     }
 }
 
@@ -319,7 +755,23 @@ void CO::removeComponent(Component *component)
         removeFile(dirPath() + CO_DATASHEET_PATH + d->path());
         component->removeDatasheet(d);
     }
+
+    if(!m_loading)
+        m_pendingRecords.append(Journal::Record(Journal::ComponentRemove,
+                                                QStringList() << component->name()));
+    discardComponent(component);
+}
+
+// Drops a component from the lists and indexes, leaving its files alone
+void CO::discardComponent(Component *component)
+{
     m_components.removeOne(component);
+    m_componentById[component->ID()] = 0;
+    m_componentIndex.remove(component->ID());
+    unbucketComponent(component, component->primaryLabel(), component->secondaryLabel());
+    unindexName(m_componentByName, m_components, component, component->name());
+    m_dirtyComponents.remove(component);
+    m_toLink.remove(component);
     delete component;
 }
 
@@ -336,7 +788,28 @@ void CO::removeApplicationNote(ApplicationNote *appnote)
     if(!appnote->attachedFilePath().isEmpty())
         removeFile(dirPath() + CO_APPNOTE_PATH + appnote->attachedFilePath());
 
+    if(!m_loading)
+        m_pendingRecords.append(Journal::Record(Journal::ApplicationNoteRemove,
+                                                QStringList() << appnote->description()));
+    discardApplicationNote(appnote);
+}
+
+void CO::discardApplicationNote(ApplicationNote *appnote)
+{
     m_appnotes.removeOne(appnote);
+    m_appnoteById.remove(appnote->ID());
+    m_appnoteIndex.remove(appnote->ID());
+    if(m_appnoteByDescription.value(appnote->description()) == appnote)
+    {
+        m_appnoteByDescription.remove(appnote->description());
+        foreach(ApplicationNote *a, m_appnotes)
+            if(a->description() == appnote->description())
+            {
+                m_appnoteByDescription.insert(a->description(), a);
+                break;
+            }
+    }
+    m_dirtyAppnotes.remove(appnote);
     delete appnote;
 }
 
@@ -348,92 +821,53 @@ void CO::removeApplicationNote(const QString &description)
 
 Component *CO::findComponent(int ID)
 {
-    foreach(Component *c, m_components)
-        if(c->ID() == ID)
-            return c;
-
-    return 0;
+    return (ID >= 0 && ID < m_componentById.size()) ? m_componentById.at(ID) : 0;
 }
 
 Component *CO::findComponent(const QString &name)
 {
-    foreach(Component *c, m_components)
-        if(c->name().compare(name) == 0)
-            return c;
+    return m_componentByName.value(name, 0);
+}
 
-    return 0;
+ApplicationNote *CO::findApplicationNote(int ID)
+{
+    return m_appnoteById.value(ID, 0);
 }
 
 ApplicationNote *CO::findApplicationNote(const QString &description)
 {
-    foreach(ApplicationNote *a, m_appnotes)
-        if(a->description().compare(description) == 0)
-            return a;
-
-    return 0;
+    return m_appnoteByDescription.value(description, 0);
 }
 
 Manufacturer *CO::findManufacturer(const QString &name)
 {
-    foreach(Manufacturer *m, m_manufacturers)
-        if(m->name().compare(name) == 0)
-            return m;
-
-    return 0;
+    return m_manufacturerByName.value(name, 0);
 }
 
 Package *CO::findPackage(const QString &name)
 {
-    foreach(Package *p, m_packages)
-        if(p->name().compare(name) == 0)
-            return p;
-
-    return 0;
+    return m_packageByName.value(name, 0);
 }
 
 Container *CO::findContainer(const QString &name)
 {
-    foreach(Container *c, m_containers)
-        if(c->name().compare(name) == 0)
-            return c;
-
-    return 0;
+    return m_containerByName.value(name, 0);
 }
 
 Label *CO::findTopLabel(const QString &name)
 {
-    foreach(Label *top, m_topLabels)
-        if(top->name().compare(name) == 0)
-            return top;
-
-    return 0;
+    return m_topLabelByName.value(name, 0);
 }
 
 Label *CO::findLabel(const QString &name)
 {
-    foreach(Label *top, m_topLabels)
-    {
-        if(top->name().compare(name) == 0)
-            return top;
-        foreach(Label *leaf, top->leafs())
-            if(leaf->name().compare(name) == 0)
-                return leaf;
-    }
-
-    return 0;
+    return m_labelByName.value(name, 0);
 }
 
 //TODO: add method
 Label *CO::findSecondaryLabel(Label *top, const QString &name)
 {
-    //sketch
-    foreach(Label *leaf, top->leafs())
-    {
-        if(leaf->name().compare(name) == 0)
-            return leaf;
-    }
-
-    return 0;
+    return top->leaf(name);
 }
 
 QStringList CO::componentNames()
@@ -497,13 +931,17 @@ bool CO::removeFile(const QString &filePath)
 //    return true;
 }
 
+// Written aside, synced and renamed over data.xml, so a crash or a full
+// disk leaves either the old or the new data.xml, never a truncated one.
+// The previous data.xml is kept as data.xml.bak.
 bool CO::writeXML(const QString &filePath)
 {
     copyFile(filePath, filePath + ".bak");
 
-    QFile file(filePath);
+    QString tempPath = filePath + ".tmp";
+    QFile file(tempPath);
 
-    if(!file.open(QIODevice::WriteOnly))
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
     {
         qDebug() << "Unable to write XML file:" << file.errorString();
         return false;
@@ -518,6 +956,7 @@ bool CO::writeXML(const QString &filePath)
 
     stream.writeStartElement("comporg");
     stream.writeAttribute("version", CO_VERSION);
+    stream.writeAttribute("journal", QString::number(m_generation));
 
     stream.writeStartElement("manufacturers");
     stream.writeAttribute("n", QString::number(m_manufacturers.count()));
@@ -572,303 +1011,589 @@ bool CO::writeXML(const QString &filePath)
     stream.writeAttribute("n", QString::number(m_components.count()));
 
     foreach(Component *c, m_components)
-    {
-        stream.writeStartElement("component");
+        writeComponent(stream, c);
 
-        stream.writeAttribute("name", c->name());
-        stream.writeTextElement("description", c->description());
+    stream.writeEndElement(); // </components>
 
-        stream.writeStartElement("datasheets");
-        stream.writeAttribute("n", QString::number(c->datasheets().count()));
-        stream.writeAttribute("default", QString::number(c->defaultDatasheetIndex()));
-        if(c->isLinked())
-            stream.writeAttribute("link", c->linkedTo()->name());
-        else
-            stream.writeAttribute("link", "");
-        foreach(Datasheet *d, c->datasheets())
-        {
-            stream.writeStartElement("datasheet");
-            stream.writeAttribute("type", Datasheet::typeToString(d->type()));
-
-            if(d->manufacturer() != 0 && d->manufacturer()->name() != "0") //TODO: error
-                stream.writeAttribute("manufacturer", d->manufacturer()->name());
-            else
-                stream.writeAttribute("manufacturer", "");
-            stream.writeAttribute("path", d->path());
-            stream.writeEndElement(); // </datasheet>
-        }
-        stream.writeEndElement(); // </datasheets>
+    stream.writeStartElement("appnotes");
+    stream.writeAttribute("n", QString::number(m_appnotes.count()));
+    foreach(ApplicationNote *a, m_appnotes)
+        writeApplicationNote(stream, a);
+    stream.writeEndElement(); // </appnotes>
 
-        stream.writeStartElement("stocks");
-        stream.writeAttribute("n", QString::number(c->stocks().count()));
-        stream.writeAttribute("ignore", QString(c->ignoreStock() ? "true" : "false"));
-        foreach(Stock *s, c->stocks())
-        {
-            stream.writeStartElement("stock");
-            stream.writeAttribute("package", s->package()->name());
-            stream.writeAttribute("value", QString::number(s->stock()));
-            stream.writeAttribute("low", QString::number(s->lowValue()));
-            stream.writeEndElement(); // </stock>
-        }
-        stream.writeEndElement(); // </stocks>
+    stream.writeEndElement(); // </comporg>
 
-        stream.writeStartElement("container");
-        if(c->container() != 0)
-            stream.writeAttribute("name", c->container()->name());
-        else
-            stream.writeAttribute("name", "");
-        stream.writeEndElement(); // </container>
-
-        stream.writeStartElement("labels");
-        int count = 0;
-        if(c->primaryLabel() != 0) count++;
-        if(c->secondaryLabel() != 0) count++;
-        stream.writeAttribute("n", QString::number(count++));
-        if(c->primaryLabel() != 0)
-        {
-            stream.writeStartElement("label");
-            stream.writeAttribute("level", QString::number(0));
-            stream.writeAttribute("name", c->primaryLabel()->name());
-            stream.writeEndElement(); // </plabel>
-        }
-        if(c->secondaryLabel() != 0)
-        {
-            stream.writeStartElement("label");
-            stream.writeAttribute("level", QString::number(1));
-            stream.writeAttribute("name", c->secondaryLabel()->name());
-            stream.writeEndElement(); // </slabel>
-        }
-        stream.writeEndElement(); // </labels>
+    stream.writeEndDocument();
 
-        stream.writeTextElement("notes", c->notes());
+    // Must be on disk before the journal it replaces is dropped
+    bool ok = !stream.hasError() && file.flush() && Journal::sync(file);
+    file.close();
 
-        stream.writeEndElement(); // </component>
+    if(!ok || !Journal::replace(tempPath, filePath))
+    {
+        qDebug() << "Unable to write XML file:" << file.errorString();
+        QFile::remove(tempPath);
+        return false;
     }
 
-    stream.writeEndElement(); // </components>
+    return true;
+}
 
-    stream.writeStartElement("appnotes");
-    stream.writeAttribute("n", QString::number(m_appnotes.count()));
-    foreach(ApplicationNote *a, m_appnotes)
+void CO::writeComponent(QXmlStreamWriter &stream, Component *c)
+{
+    stream.writeStartElement("component");
+
+    stream.writeAttribute("name", c->name());
+    stream.writeTextElement("description", c->description());
+
+    stream.writeStartElement("datasheets");
+    stream.writeAttribute("n", QString::number(c->datasheets().count()));
+    stream.writeAttribute("default", QString::number(c->defaultDatasheetIndex()));
+    if(c->isLinked())
+        stream.writeAttribute("link", c->linkedTo()->name());
+    else
+        stream.writeAttribute("link", "");
+    foreach(Datasheet *d, c->datasheets())
     {
-        stream.writeStartElement("appnote");
-        stream.writeAttribute("description", a->description());
-        stream.writeAttribute("name", a->name());
-        stream.writeAttribute("path", a->pdfPath());
-        stream.writeAttribute("attachedFile", a->attachedFilePath());
+        stream.writeStartElement("datasheet");
+        stream.writeAttribute("type", Datasheet::typeToString(d->type()));
 
-        stream.writeEndElement(); // </appnote>
+        if(d->manufacturer() != 0 && d->manufacturer()->name() != "0") //TODO: error
+            stream.writeAttribute("manufacturer", d->manufacturer()->name());
+        else
+            stream.writeAttribute("manufacturer", "");
+        stream.writeAttribute("path", d->path());
+        stream.writeEndElement(); // </datasheet>
     }
-    stream.writeEndElement(); // </appnotes>
+    stream.writeEndElement(); // </datasheets>
 
-    stream.writeEndElement(); // </comporg>
+    stream.writeStartElement("stocks");
+    stream.writeAttribute("n", QString::number(c->stocks().count()));
+    stream.writeAttribute("ignore", QString(c->ignoreStock() ? "true" : "false"));
+    foreach(const Stock &s, c->stocks())
+    {
+        stream.writeStartElement("stock");
+        stream.writeAttribute("package", s.package()->name());
+        stream.writeAttribute("value", QString::number(s.stock()));
+        stream.writeAttribute("low", QString::number(s.lowValue()));
+        stream.writeEndElement(); // </stock>
+    }
+    stream.writeEndElement(); // </stocks>
 
-    stream.writeEndDocument();
+    stream.writeStartElement("container");
+    if(c->container() != 0)
+        stream.writeAttribute("name", c->container()->name());
+    else
+        stream.writeAttribute("name", "");
+    stream.writeEndElement(); // </container>
 
-    return true;
+    stream.writeStartElement("labels");
+    int count = 0;
+    if(c->primaryLabel() != 0) count++;
+    if(c->secondaryLabel() != 0) count++;
+    stream.writeAttribute("n", QString::number(count++));
+    if(c->primaryLabel() != 0)
+    {
+        stream.writeStartElement("label");
+        stream.writeAttribute("level", QString::number(0));
+        stream.writeAttribute("name", c->primaryLabel()->name());
+        stream.writeEndElement(); // </plabel>
+    }
+    if(c->secondaryLabel() != 0)
+    {
+        stream.writeStartElement("label");
+        stream.writeAttribute("level", QString::number(1));
+        stream.writeAttribute("name", c->secondaryLabel()->name());
+        stream.writeEndElement(); // </slabel>
+    }
+    stream.writeEndElement(); // </labels>
+
+    stream.writeTextElement("notes", c->notes());
+
+    stream.writeEndElement(); // </component>
+}
+
+void CO::writeApplicationNote(QXmlStreamWriter &stream, ApplicationNote *a)
+{
+    stream.writeStartElement("appnote");
+    stream.writeAttribute("description", a->description());
+    stream.writeAttribute("name", a->name());
+    stream.writeAttribute("path", a->pdfPath());
+    stream.writeAttribute("attachedFile", a->attachedFilePath());
+
+    stream.writeEndElement(); // </appnote>
 }
 
 bool CO::readXML(const QString &filePath)
 {
     QFile file(filePath);
 
+    m_xmlPath = filePath;
+
     if(!file.open(QIODevice::ReadOnly))
     {
         qDebug() << "Unable to read XML file:" << file.errorString();
         return false;
     }
 
-    QXmlStreamReader xml(&file);
+    QElapsedTimer timer;
+    timer.start();
 
-    while(!xml.atEnd())
+    m_loading = true;
+    m_generation = 0;
+
+    QString snapshotPath = filePath + CO_SNAPSHOT_SUFFIX;
+    bool fromSnapshot = Snapshot::read(this, snapshotPath, filePath, &m_generation, &m_toLink);
+
+    if(!fromSnapshot)
     {
-        xml.readNext();
+        QXmlStreamReader xml(&file);
 
-        switch(xml.tokenType())
+        while(!xml.atEnd())
         {
-            case QXmlStreamReader::StartElement:
-                processXmlNode(xml);
-                break;
-            default:
-                ;
+            xml.readNext();
+
+            switch(xml.tokenType())
+            {
+                case QXmlStreamReader::StartElement:
+                    processXmlNode(xml);
+                    break;
+                default:
+                    ;
+            }
         }
-    }
 
-    if(xml.hasError())
-    {
-        qDebug() << "XML error:" << xml.errorString();
-        return false;
+        if(xml.hasError())
+        {
+            qDebug() << "XML error:" << xml.errorString();
+            m_loading = false;
+            return false;
+        }
+
+        // Before the journal is replayed: the snapshot mirrors data.xml only
+        Snapshot::write(this, snapshotPath, filePath, m_generation, m_toLink);
     }
-    else
+
+    // Edits saved after the last compaction
+    QList<Journal::Record> records;
+    if(m_journal.open(filePath + CO_JOURNAL_SUFFIX, m_generation, &records))
     {
-        linkDatasheets();
+        replayJournal(records);
+        m_compactPending = false;
     }
 
+    m_ledger.open(filePath + CO_LEDGER_SUFFIX);
+
+    linkDatasheets();
+    m_loading = false;
+
+    m_loadStats.elapsed = timer.elapsed();
+    m_loadStats.fromSnapshot = fromSnapshot;
+    m_loadStats.components = m_components.count();
+    m_loadStats.applicationNotes = m_appnotes.count();
+    m_loadStats.journalRecords = records.count();
+
+    qDebug() << "readXML:" << m_loadStats.components << "components loaded from"
+             << (fromSnapshot ? "snapshot" : "XML") << "in" << m_loadStats.elapsed << "ms,"
+             << m_loadStats.journalRecords << "journal records replayed";
+
     return true;
 }
 
-void CO::processXmlNode(QXmlStreamReader &xml)
+void CO::replayJournal(const QList<Journal::Record> &records)
 {
-    int n;
-    QString nodeName = xml.name().toString();
-
-    if(nodeName == "manufacturer")
+    foreach(const Journal::Record &r, records)
     {
-        QString name = xml.attributes().at(0).value().toString();
-        Manufacturer *m = new Manufacturer(name);
-        qDebug() << name;
-
-        addManufacturer(m);
+        switch(r.type)
+        {
+            case Journal::ComponentUpdate:
+            {
+                Component *c = findComponent(r.fields.value(0));
+                if(c != 0)
+                    discardComponent(c);
+                processXmlFragment(r.fields.value(1));
+                break;
+            }
+            case Journal::ComponentRemove:
+            {
+                Component *c = findComponent(r.fields.value(0));
+                if(c != 0)
+                    discardComponent(c);
+                break;
+            }
+            case Journal::ComponentRename:
+            {
+                Component *c = findComponent(r.fields.value(0));
+                if(c != 0)
+                    c->setName(r.fields.value(1));
+                break;
+            }
+            case Journal::ApplicationNoteUpdate:
+            {
+                ApplicationNote *a = findApplicationNote(r.fields.value(0));
+                if(a != 0)
+                    discardApplicationNote(a);
+                processXmlFragment(r.fields.value(1));
+                break;
+            }
+            case Journal::ApplicationNoteRemove:
+            {
+                ApplicationNote *a = findApplicationNote(r.fields.value(0));
+                if(a != 0)
+                    discardApplicationNote(a);
+                break;
+            }
+            case Journal::ApplicationNoteRename:
+            {
+                ApplicationNote *a = findApplicationNote(r.fields.value(0));
+                if(a != 0)
+                    a->setDescription(r.fields.value(1));
+                break;
+            }
+            case Journal::StockDelta:
+            {
+                Component *c = findComponent(r.fields.value(0));
+                Stock *s = (c != 0) ? c->stock(r.fields.value(1)) : 0;
+                if(s != 0)
+                    s->setStock(s->stock() + r.value);
+                break;
+            }
+            case Journal::StockBatch:
+            {
+                for(int i = 0; i + 2 < r.fields.count(); i += 3)
+                {
+                    Component *c = findComponent(r.fields.at(i));
+                    Stock *s = (c != 0) ? c->stock(r.fields.at(i + 1)) : 0;
+                    if(s != 0)
+                        s->setStock(s->stock() + r.fields.at(i + 2).toInt());
+                }
+                break;
+            }
+            default:
+                qDebug() << "journal: unknown record type" << r.type;
+        }
     }
-    else if(nodeName == "package")
-    {
-        QString name = xml.attributes().at(0).value().toString();
-        Package *p = new Package(name);
-        qDebug() << name;
+}
 
-        addPackage(p);
-    }
-    else if(nodeName == "container")
+void CO::processXmlFragment(const QString &fragment)
+{
+    QXmlStreamReader xml(fragment);
+
+    while(!xml.atEnd())
     {
-        QString name = xml.attributes().at(0).value().toString();
-        Container *c = new Container(name);
-        qDebug() << name;
+        xml.readNext();
+        if(xml.isStartElement())
+            processXmlNode(xml);
+    }
+}
 
-        addContainer(c);
+// Integer value of an attribute, read in place instead of through a
+// temporary QString. Like QString::toInt(), anything malformed gives 0.
+static int attributeToInt(const QStringRef &value)
+{
+    int i = 0;
+    bool negative = false;
+    if(!value.isEmpty() && value.at(0) == '-')
+    {
+        negative = true;
+        i++;
     }
-    else if(nodeName == "label") // level=0
+
+    if(i == value.size())
+        return 0;
+
+    int result = 0;
+    for(; i < value.size(); i++)
     {
-        QString pName = xml.attributes().at(0).value().toString();
-        Label *pLabel = new Label(pName);
-        qDebug() << pName;
+        ushort digit = value.at(i).unicode() - '0';
+        if(digit > 9)
+            return 0;
+        result = result * 10 + digit;
+    }
 
-        int leafs = xml.attributes().at(1).value().toString().toInt();
-        while(leafs-- > 0)
-        {
-            xml.readNextStartElement(); // level=1
+    return negative ? -result : result;
+}
 
-            QString sName = xml.attributes().at(0).value().toString();
-            Label *sLabel = new Label(sName);
-            qDebug() << sName;
-            sLabel->setTop(pLabel);
-            pLabel->addLeaf(sLabel);
+// Text of the attribute called 'name', empty when the element has none
+static QString attributeText(const QXmlStreamAttributes &attributes, XmlNames::Name name)
+{
+    foreach(const QXmlStreamAttribute &attribute, attributes)
+        if(XmlNames::lookup(attribute.name()) == name)
+            return attribute.value().toString();
 
-            xml.skipCurrentElement();
-        }
+    return QString();
+}
 
-        addTopLabel(pLabel);
-    }
-    else if(nodeName == "component")
+// Elements and attributes are matched by name, not position, so their
+// order does not matter. Anything the reader does not know is skipped
+// whole with skipCurrentElement(). Attribute values are looked at through
+// QStringRefs into the reader's buffer; only the text that ends up stored
+// in a record is copied out.
+void CO::processXmlNode(QXmlStreamReader &xml)
+{
+    switch(XmlNames::lookup(xml.name()))
     {
-        QString name = xml.attributes().at(0).value().toString();
-        Component *c = new Component(name);
-        qDebug() << name;
+        case XmlNames::Comporg:
+            foreach(const QXmlStreamAttribute &attribute, xml.attributes())
+                if(XmlNames::lookup(attribute.name()) == XmlNames::Journal)
+                    m_generation = attribute.value().toString().toUInt();
+            break;
+
+        case XmlNames::Manufacturers:
+        case XmlNames::Packages:
+        case XmlNames::Containers:
+        case XmlNames::Labels:
+        case XmlNames::Components:
+        case XmlNames::Appnotes:
+            break;  // their children come through here one by one
+
+        case XmlNames::Manufacturer:
+            addManufacturer(new Manufacturer(attributeText(xml.attributes(), XmlNames::NameAttribute)));
+            xml.skipCurrentElement();
+            break;
 
-        xml.readNextStartElement(); // description
-        c->setDescription(xml.readElementText());
+        case XmlNames::Package:
+            addPackage(new Package(attributeText(xml.attributes(), XmlNames::NameAttribute)));
+            xml.skipCurrentElement();
+            break;
 
-        xml.readNextStartElement(); // datasheets
-        qDebug() << xml.name();
-        n = xml.attributes().at(0).value().toString().toInt();
-        int defaultIndex = xml.attributes().at(1).value().toString().toInt();
-        QString link = xml.attributes().at(2).value().toString();
-        if(!link.isEmpty())
-            m_toLink.insert(c, link);
+        case XmlNames::Container:
+            addContainer(new Container(attributeText(xml.attributes(), XmlNames::NameAttribute)));
+            xml.skipCurrentElement();
+            break;
 
-        while(n-- > 0)
+        case XmlNames::Label:   // level=0, its leafs are the level=1 labels
         {
-            xml.readNextStartElement(); // datasheet
-            qDebug() << xml.name();
+            Label *pLabel = new Label(attributeText(xml.attributes(), XmlNames::NameAttribute));
 
-            QString type = xml.attributes().at(0).value().toString();
-            QString manufacturer = xml.attributes().at(1).value().toString();
-            QString path = xml.attributes().at(2).value().toString();
-            Datasheet *d = new Datasheet(path);
-            d->setType(Datasheet::typeFromString(type));
-            d->setManufacturer(findManufacturer(manufacturer));
-            c->addDatasheet(d);
+            while(xml.readNextStartElement())
+            {
+                if(XmlNames::lookup(xml.name()) == XmlNames::Label)
+                {
+                    Label *sLabel = new Label(attributeText(xml.attributes(), XmlNames::NameAttribute));
+                    sLabel->setTop(pLabel);
+                    pLabel->addLeaf(sLabel);
+                }
+                xml.skipCurrentElement();
+            }
 
-            xml.skipCurrentElement();
+            addTopLabel(pLabel);
+            break;
         }
-        c->setDefaultDatasheetIndex(defaultIndex);
-        xml.skipCurrentElement();
-
-        xml.readNextStartElement(); // stocks
-        qDebug() << xml.name();
-        n = xml.attributes().at(0).value().toString().toInt();
-        if(xml.attributes().at(1).value().toString() == "true")
-            c->setIgnoreStock(true);
-        else
-            c->setIgnoreStock(false);
 
-        while(n-- > 0)
+        case XmlNames::Component:
+            processXmlComponent(xml);
+            break;
+
+        case XmlNames::Appnote:
         {
-            xml.readNextStartElement(); // stock
-            qDebug() << xml.name();
-
-            QString packageName = xml.attributes().at(0).value().toString();
-            int value = xml.attributes().at(1).value().toString().toInt();
-            int low = xml.attributes().at(2).value().toString().toInt();
-            Stock *s = new Stock(findPackage(packageName));
-            s->setStock(value);
-            s->setLowValue(low);
-            c->addStock(s);
+            QString description;
+            QString name;
+            QString pdfPath;
+            QString attachedFilePath;
+
+            foreach(const QXmlStreamAttribute &attribute, xml.attributes())
+            {
+                switch(XmlNames::lookup(attribute.name()))
+                {
+                    case XmlNames::Description:
+                        description = attribute.value().toString();
+                        break;
+                    case XmlNames::NameAttribute:
+                        name = attribute.value().toString();
+                        break;
+                    case XmlNames::Path:
+                        pdfPath = attribute.value().toString();
+                        break;
+                    case XmlNames::AttachedFile:
+                        attachedFilePath = attribute.value().toString();
+                        break;
+                    default:
+                        ;
+                }
+            }
             xml.skipCurrentElement();
+
+            ApplicationNote *a = new ApplicationNote(description);
+            a->setName(name);
+            a->setPdfPath(pdfPath);
+            a->setAttachedFilePath(attachedFilePath);
+
+            addApplicationNote(a);
+            break;
         }
-        xml.skipCurrentElement();
 
-        xml.readNextStartElement(); // container
-        qDebug() << xml.name();
-        c->setContainer(findContainer(xml.attributes().at(0).value().toString()));
-        xml.skipCurrentElement();
+        default:
+            xml.skipCurrentElement();
+    }
+}
+
+void CO::processXmlComponent(QXmlStreamReader &xml)
+{
+    Component *c = new Component(attributeText(xml.attributes(), XmlNames::NameAttribute));
+    int defaultIndex = -1;
+    QString primaryLabel;
+    QString secondaryLabel;
 
-        xml.readNextStartElement(); // labels
-        qDebug() << xml.name();
-        n = xml.attributes().at(0).value().toString().toInt();
-        while(n-- > 0)
+    while(xml.readNextStartElement())
+    {
+        switch(XmlNames::lookup(xml.name()))
         {
-            xml.readNextStartElement(); // label
-            qDebug() << xml.name();
+            case XmlNames::Description:
+                c->setDescription(xml.readElementText(QXmlStreamReader::SkipChildElements));
+                break;
 
-            int level = xml.attributes().at(0).value().toString().toInt();
-            QString labelName = xml.attributes().at(1).value().toString();
-            switch(level)
-            {
-                case 0:
-                    c->setLabel((Component::LabelLevel)level, findTopLabel(labelName));
-                    break;
-                case 1:
-                    c->setLabel((Component::LabelLevel)level, findTopLabel(c->primaryLabel()->name())->leaf(labelName));
-                    break;
-                default:
-                    ;
-            }
+            case XmlNames::Notes:
+                c->setNotes(xml.readElementText(QXmlStreamReader::SkipChildElements));
+                break;
 
-            xml.skipCurrentElement();
-        }
-        xml.skipCurrentElement();
-        xml.readNextStartElement(); // notes
-        c->setNotes(xml.readElementText());
+            case XmlNames::Datasheets:
+                foreach(const QXmlStreamAttribute &attribute, xml.attributes())
+                {
+                    switch(XmlNames::lookup(attribute.name()))
+                    {
+                        case XmlNames::Default:
+                            defaultIndex = attributeToInt(attribute.value());
+                            break;
+                        case XmlNames::Link:
+                            if(!attribute.value().isEmpty())
+                                m_toLink.insert(c, attribute.value().toString());
+                            break;
+                        default:
+                            ;
+                    }
+                }
+
+                while(xml.readNextStartElement())
+                {
+                    if(XmlNames::lookup(xml.name()) == XmlNames::Datasheet)
+                    {
+                        Datasheet::Type type = Datasheet::Normal;
+                        Manufacturer *manufacturer = 0;
+                        QString path;
+
+                        foreach(const QXmlStreamAttribute &attribute, xml.attributes())
+                        {
+                            switch(XmlNames::lookup(attribute.name()))
+                            {
+                                case XmlNames::Type:
+                                    type = Datasheet::typeFromString(attribute.value().toString());
+                                    break;
+                                case XmlNames::Manufacturer:
+                                    manufacturer = findManufacturer(attribute.value().toString());
+                                    break;
+                                case XmlNames::Path:
+                                    path = attribute.value().toString();
+                                    break;
+                                default:
+                                    ;
+                            }
+                        }
+
+                        Datasheet *d = new Datasheet(path);
+                        d->setType(type);
+                        d->setManufacturer(manufacturer);
+                        c->addDatasheet(d);
+                    }
+                    xml.skipCurrentElement();
+                }
+                break;
+
+            case XmlNames::Stocks:
+                c->setIgnoreStock(false);
+                foreach(const QXmlStreamAttribute &attribute, xml.attributes())
+                    if(XmlNames::lookup(attribute.name()) == XmlNames::Ignore)
+                        c->setIgnoreStock(attribute.value() == QLatin1String("true"));
+
+                while(xml.readNextStartElement())
+                {
+                    if(XmlNames::lookup(xml.name()) == XmlNames::Stock)
+                    {
+                        Package *package = 0;
+                        int value = 0;
+                        int low = 0;
+
+                        foreach(const QXmlStreamAttribute &attribute, xml.attributes())
+                        {
+                            switch(XmlNames::lookup(attribute.name()))
+                            {
+                                case XmlNames::Package:
+                                    package = findPackage(attribute.value().toString());
+                                    break;
+                                case XmlNames::Value:
+                                    value = attributeToInt(attribute.value());
+                                    break;
+                                case XmlNames::Low:
+                                    low = attributeToInt(attribute.value());
+                                    break;
+                                default:
+                                    ;
+                            }
+                        }
+
+                        Stock s(package);
+                        s.setStock(value);
+                        s.setLowValue(low);
+                        c->addStock(s);
+                    }
+                    xml.skipCurrentElement();
+                }
+                break;
 
-        xml.skipCurrentElement();
+            case XmlNames::Container:
+                c->setContainer(findContainer(attributeText(xml.attributes(), XmlNames::NameAttribute)));
+                xml.skipCurrentElement();
+                break;
 
-        addComponent(c);
+            case XmlNames::Labels:
+                while(xml.readNextStartElement())
+                {
+                    if(XmlNames::lookup(xml.name()) == XmlNames::Label)
+                    {
+                        int level = -1;
+                        QString name;
+
+                        foreach(const QXmlStreamAttribute &attribute, xml.attributes())
+                        {
+                            switch(XmlNames::lookup(attribute.name()))
+                            {
+                                case XmlNames::Level:
+                                    level = attributeToInt(attribute.value());
+                                    break;
+                                case XmlNames::NameAttribute:
+                                    name = attribute.value().toString();
+                                    break;
+                                default:
+                                    ;
+                            }
+                        }
+
+                        if(level == Component::PrimaryLabel)
+                            primaryLabel = name;
+                        else if(level == Component::SecondaryLabel)
+                            secondaryLabel = name;
+                    }
+                    xml.skipCurrentElement();
+                }
+                break;
+
+            default:
+                xml.skipCurrentElement();
+        }
     }
-    else if(nodeName == "appnote")
-    {
-        QString description = xml.attributes().at(0).value().toString();
-        QString name = xml.attributes().at(1).value().toString();
-        QString pdfPath = xml.attributes().at(2).value().toString();
-        QString attachedFilePath = xml.attributes().at(3).value().toString();
 
-        ApplicationNote *a = new ApplicationNote(description);
-        a->setName(name);
-        a->setPdfPath(pdfPath);
-        a->setAttachedFilePath(attachedFilePath);
+    c->setDefaultDatasheetIndex(defaultIndex);
 
-        addApplicationNote(a);
+    // The secondary label is a leaf of the primary one, whichever came first
+    if(!primaryLabel.isNull())
+    {
+        Label *top = findTopLabel(primaryLabel);
+        c->setLabel(Component::PrimaryLabel, top);
+        if(top && !secondaryLabel.isNull())
+            c->setLabel(Component::SecondaryLabel, top->leaf(secondaryLabel));
     }
 
+    addComponent(c);
 }
 
 void CO::linkDatasheets()
@@ -882,9 +1607,85 @@ void CO::linkDatasheets()
 
         ++i;
     }
+    m_toLink.clear();
 }
 
+// Saves the edits made since the last call: appended to the journal, or
+// folded into a rewritten data.xml when a compaction is due.
 bool CO::updateDataXML()
 {
-    return writeXML(dirPath() + CO_XML_PATH);
+    if(m_xmlPath.isEmpty())
+        m_xmlPath = dirPath() + CO_XML_PATH;
+
+    if(m_compactPending || !m_journal.isOpen() || m_journal.size() > CO_JOURNAL_MAX_SIZE)
+        return compactXML();
+
+    return flushJournal();
+}
+
+bool CO::flushJournal()
+{
+    QList<Journal::Record> records = m_pendingRecords;
+
+    foreach(Component *c, m_dirtyComponents)
+    {
+        QString fragment;
+        QXmlStreamWriter stream(&fragment);
+        writeComponent(stream, c);
+        records.append(Journal::Record(Journal::ComponentUpdate, QStringList() << c->name() << fragment));
+    }
+
+    foreach(ApplicationNote *a, m_dirtyAppnotes)
+    {
+        QString fragment;
+        QXmlStreamWriter stream(&fragment);
+        writeApplicationNote(stream, a);
+        records.append(Journal::Record(Journal::ApplicationNoteUpdate, QStringList() << a->description() << fragment));
+    }
+
+    if(records.isEmpty())
+        return true;
+
+    if(!m_journal.append(records))
+        return compactXML();
+
+    m_pendingRecords.clear();
+    m_dirtyComponents.clear();
+    m_dirtyAppnotes.clear();
+
+    return true;
+}
+
+// Rewrites data.xml with the current state and starts an empty journal for
+// the new generation
+bool CO::compactXML()
+{
+    m_generation++;
+
+    if(!writeXML(m_xmlPath))
+    {
+        m_generation--;
+        return false;
+    }
+
+    // data.xml now carries the next generation, so the old journal is
+    // ignored from here on. Without a new one later edits cannot be
+    // journaled: the next save compacts again.
+    if(!m_journal.create(m_xmlPath + CO_JOURNAL_SUFFIX, m_generation))
+    {
+        m_journal.close();
+        m_compactPending = true;
+        return false;
+    }
+
+    if(!m_ledger.isOpen())
+        m_ledger.open(m_xmlPath + CO_LEDGER_SUFFIX);
+    Snapshot::write(this, m_xmlPath + CO_SNAPSHOT_SUFFIX, m_xmlPath, m_generation, m_toLink);
+
+    m_pendingRecords.clear();
+    m_dirtyComponents.clear();
+    m_dirtyAppnotes.clear();
+    m_compactPending = false;
+
+    return true;
 }
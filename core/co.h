@@ -21,6 +21,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QObject>
 #include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include "journal.h"
+#include "searchindex.h"
+#include "smtprofilelibrary.h"
+#include "stockledger.h"
 
 class Component;
 class ApplicationNote;
@@ -29,13 +37,17 @@ class Package;
 class Container;
 class Label;
 
+class Stock;
+
 class QXmlStreamReader;
+class QXmlStreamWriter;
 
 class CO : public QObject
 {
     Q_OBJECT
 public:
     explicit CO(QObject *parent = 0);
+    ~CO();
 
     QString dirPath()
     {
@@ -44,10 +56,17 @@ public:
 
     void useDefaultData();
 
+    // SMT feeder profiles of the data directory, cached for the session
+    SmtProfileLibrary *profileLibrary()
+    {
+        return &m_profileLibrary;
+    }
+
     void addManufacturer(Manufacturer *manufacturer);
     void addPackage(Package *package);
     void addContainer(Container *container);
     void addTopLabel(Label *topLabel);
+    void addSecondaryLabel(Label *top, Label *leaf);
     void addComponent(Component *component);
     void addApplicationNote(ApplicationNote *appnote);
 
@@ -72,6 +91,7 @@ public:
 
     Component *findComponent(int ID);
     Component *findComponent(const QString &name);
+    ApplicationNote *findApplicationNote(int ID);
     ApplicationNote *findApplicationNote(const QString &description);
     Manufacturer *findManufacturer(const QString &name);
     Package *findPackage(const QString &name);
@@ -80,6 +100,20 @@ public:
     Label *findLabel(const QString &name);
     Label *findSecondaryLabel(Label *top, const QString &name);
 
+    // Figures of the last readXML(), for benchmarks and the command line
+    struct LoadStats
+    {
+        qint64 elapsed;         // ms, journal replay and linking included
+        bool fromSnapshot;
+        int components;
+        int applicationNotes;
+        int journalRecords;
+    };
+    LoadStats loadStats() const
+    {
+        return m_loadStats;
+    }
+
     QStringList componentNames();
     QStringList appnoteNames();
     QStringList manufacturerNames();
@@ -90,9 +124,72 @@ public:
     {
         return m_topLabels;
     }
+    QList<Manufacturer *> manufacturers()
+    {
+        return m_manufacturers;
+    }
+    QList<Container *> containers()
+    {
+        return m_containers;
+    }
+
+    // Components by label, kept up to date as labels are assigned. A
+    // component is listed under both its primary and secondary label;
+    // unlabeledComponents() are those without a primary label.
+    QSet<Component *> componentsWithLabel(Label *label)
+    {
+        return m_componentsByLabel.value(label);
+    }
+    QSet<Component *> unlabeledComponents()
+    {
+        return m_unlabeledComponents;
+    }
+    QSet<Component *> componentsWithLabels(Label *primary, Label *secondary);
+
+    // Change tracking for updateDataXML(). Adding and removing entities is
+    // tracked by CO itself; edits made on existing objects must be reported.
+    void componentChanged(Component *component);
+    void applicationNoteChanged(ApplicationNote *appnote);
+    void stockChanged(Component *component, Stock *stock, int delta);
+    void catalogChanged();
+
+    // Stock moves booked as a unit: applied in memory and saved as a single
+    // journal record, or not at all. Booked moves go to the stock ledger
+    // as kit movements, 'reference' naming the BOMs; moves whose history
+    // cannot be written are not booked.
+    struct StockMove
+    {
+        Component *component;
+        Stock *stock;
+        int delta;
+    };
+    bool moveStock(const QList<StockMove> &moves, const QString &reference = QString(),
+                   bool rollback = false, QString *errorString = 0);
+
+    // Stock history
+    bool recordStockEdit(Component *component, const QString &package, int delta);
+    int stockAt(Component *component, const Stock &stock, const QDateTime &time);
+    const StockLedger &stockLedger() const
+    {
+        return m_ledger;
+    }
+
+    // Case insensitive text search, best matches first. Components match on
+    // name, description, notes and datasheet manufacturers; application
+    // notes on description and name.
+    QList<Component *> searchComponents(const QString &text);
+    QList<ApplicationNote *> searchApplicationNotes(const QString &text);
+
+    // Copies of the indexes for searching outside the GUI thread. They hold
+    // IDs, to be resolved with findComponent() and findApplicationNote().
+    SearchIndex componentIndex();
+    SearchIndex applicationNoteIndex();
 
 signals:
 
+private slots:
+    void applicationNoteRenamed(ApplicationNote *appnote, const QString &oldDescription);
+
 public slots:
     bool execFile(const QString &filePath);
     bool copyFile(const QString &filePath, const QString &newPath);
@@ -109,13 +206,73 @@ private:
     QList<Container *>       m_containers;
     QList<Label *>            m_topLabels;
 
+    // Lookup indexes, kept in sync by the add/remove methods and by the
+    // rename notifications of the indexed objects. On duplicated names the
+    // first added object wins, as the former linear scans did. Components
+    // are looked up by ID in an array, 0 where no component has that ID.
+    QVector<Component *>                  m_componentById;
+    QHash<QString, Component *>           m_componentByName;
+    QHash<int, ApplicationNote *>         m_appnoteById;
+    QHash<QString, ApplicationNote *>     m_appnoteByDescription;
+    QHash<QString, Manufacturer *>        m_manufacturerByName;
+    QHash<QString, Package *>             m_packageByName;
+    QHash<QString, Container *>           m_containerByName;
+    QHash<QString, Label *>               m_topLabelByName;
+    QHash<QString, Label *>               m_labelByName;
+    QHash<Label *, QSet<Component *> >    m_componentsByLabel;
+    QSet<Component *>                     m_unlabeledComponents;
+
     QString m_dirPath;
+    SmtProfileLibrary m_profileLibrary;
+
+    // Called by the components themselves
+    friend class Component;
+    void componentRenamed(Component *component, const QString &oldName);
+    void componentLabelsChanged(Component *component, Label *oldPrimary, Label *oldSecondary);
+
+    // Full-text indexes, built on the first search and then kept up to date
+    // by the same calls that track edits for the journal
+    SearchIndex m_componentIndex;
+    SearchIndex m_appnoteIndex;
+    bool m_componentIndexBuilt;
+    bool m_appnoteIndexBuilt;
+    void indexComponent(Component *component);
+    void indexApplicationNote(ApplicationNote *appnote);
+
+    // Persistence: edits are appended to the journal and folded into
+    // data.xml by compactXML() once the journal grows too big, or when the
+    // catalogs (manufacturers, packages, containers, labels) change.
+    Journal m_journal;
+    QString m_xmlPath;
+    quint32 m_generation;
+    bool m_loading;
+    bool m_compactPending;
+    LoadStats m_loadStats;
+    QList<Journal::Record>     m_pendingRecords;
+    StockLedger                m_ledger;
+    QSet<Component *>          m_dirtyComponents;
+    QSet<ApplicationNote *>    m_dirtyAppnotes;
+
+    bool compactXML();
+    bool flushJournal();
+    void replayJournal(const QList<Journal::Record> &records);
+    void discardComponent(Component *component);
+    void discardApplicationNote(ApplicationNote *appnote);
+
+    void writeComponent(QXmlStreamWriter &stream, Component *c);
+    void writeApplicationNote(QXmlStreamWriter &stream, ApplicationNote *a);
 
     QMap<Component *, QString> m_toLink;
     void processXmlNode(QXmlStreamReader &xml);
+    void processXmlComponent(QXmlStreamReader &xml);
+    void processXmlFragment(const QString &fragment);
     void linkDatasheets();
 
     void initLabels();
+    void indexLabel(Label *label);
+    void unindexLabel(Label *label);
+    void bucketComponent(Component *component, Label *primary, Label *secondary);
+    void unbucketComponent(Component *component, Label *primary, Label *secondary);
 };
 
 #endif // CO_H
@@ -29,4 +29,9 @@ const QString CO_APPNOTE_PATH   = CO_DATA_PATH + "/appnote";
 const QString CO_XML_PATH       = CO_DATA_PATH + "/data.xml";
 const QString CO_SMT_PROFILE_PATH  = CO_DATA_PATH + "/profiles";
 
+const QString CO_JOURNAL_SUFFIX   = ".journal";
+const QString CO_SNAPSHOT_SUFFIX  = ".snap";
+const QString CO_LEDGER_SUFFIX    = ".ledger";
+const int     CO_JOURNAL_MAX_SIZE = 1024 * 1024; // compacted into data.xml above this
+
 #endif // CO_DEFS_H
@@ -17,20 +17,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 **********************************************************************/
 
 #include "component.h"
+#include "co.h"
 #include "datasheet.h"
-#include "stock.h"
 #include "package.h"
 #include "label.h"
+#include "recordpool.h"
+#include "namepool.h"
 
 #include <QDebug>
+#include <QtAlgorithms>
 
 int Component::nextID = 0;
 
-Component::Component(const QString name, QObject *parent) :
-    QObject(parent),
+static RecordPool<Component> pool;
+
+Component::Component(const QString &name) :
+    m_owner(0),
     m_ID(Component::nextID++),
     m_name(name),
     m_defaultDatasheetIndex(-1),
+    m_bookingStock(-1),
     m_ignoreStock(true),
     m_lowStock(0),
     m_totalStock(0),
@@ -42,6 +48,33 @@ Component::Component(const QString name, QObject *parent) :
 
 }
 
+void *Component::operator new(size_t size)
+{
+    return pool.allocate(size);
+}
+
+void Component::operator delete(void *p, size_t size)
+{
+    pool.release(p, size);
+}
+
+// Datasheets belong to the component
+Component::~Component()
+{
+    qDeleteAll(m_datasheets);
+}
+
+void Component::setName(const QString &name)
+{
+    if(m_name == name)
+        return;
+
+    QString oldName = m_name;
+    m_name = name;
+    if(m_owner != 0)
+        m_owner->componentRenamed(this, oldName);
+}
+
 void Component::addDatasheet(Datasheet *datasheet)
 {
     m_datasheets.append(datasheet);
@@ -93,30 +126,77 @@ Datasheet *Component::datasheet(const QString &path)
     return 0;
 }
 
-void Component::addStock(Stock *stock)
+// Stocks are kept sorted by the pooled ID of their package name, so a
+// lookup is a binary search over a few integers
+Stock *Component::addStock(const Stock &stock)
 {
-    m_stocks.append(stock);
-    m_totalStock += stock->stock();
+    int id = (stock.package() != 0) ? stock.package()->nameId() : -1;
+    int i = stockIndex(id);
+
+    m_stockPackages.insert(i, id);
+    m_stocks.insert(i, stock);
+
+    Stock *s = &m_stocks[i];
+    s->m_component = this;
+    m_totalStock += s->stock();
+    updateBookingStock();
+    return s;
 }
 
 void Component::removeStock(const QString &packageName)
 {
-    Stock *s = stock(packageName);
+    int id = NamePool::find(packageName);
+    Stock *s = stockById(id);
+    if(s == 0)
+        return;
+
     m_totalStock -= s->stock();
-    m_stocks.removeOne(s);
-    delete s;
+
+    int i = stockIndex(id);
+    m_stockPackages.remove(i);
+    m_stocks.remove(i);
+    updateBookingStock();
 }
 
-QList<Stock *> Component::stocks()
+void Component::updateBookingStock()
 {
-    return m_stocks;
+    m_bookingStock = -1;
+    for(int i = 0; i < m_stocks.count(); i++)
+    {
+        Package *p = m_stocks.at(i).package();
+        if(p != 0 && (m_bookingStock < 0 || p->order() < m_stocks.at(m_bookingStock).package()->order()))
+            m_bookingStock = i;
+    }
 }
 
+// Package names are pooled, so a name that was never interned has no stock
 Stock *Component::stock(const QString &packageName)
 {
-    foreach(Stock *s, m_stocks)
-        if(s->package()->name().compare(packageName) == 0)
-            return s;
+    return stockById(NamePool::find(packageName));
+}
+
+Stock *Component::stock(Package *package)
+{
+    return (package != 0) ? stockById(package->nameId()) : 0;
+}
+
+int Component::stockIndex(int packageId)
+{
+    return qLowerBound(m_stockPackages.constBegin(), m_stockPackages.constEnd(), packageId)
+           - m_stockPackages.constBegin();
+}
+
+Stock *Component::stockById(int packageId)
+{
+    if(packageId < 0)
+        return 0;
+
+    // Taken without detaching: while a copy of stocks() is being iterated
+    // the array is shared, and detaching would move the stocks away from
+    // the pointers handed out before
+    int i = stockIndex(packageId);
+    if(i < m_stockPackages.count() && m_stockPackages.at(i) == packageId)
+        return const_cast<Stock *>(&m_stocks.at(i));
 
     return 0;
 }
@@ -126,12 +206,25 @@ void Component::setLabel(int level, Label *label)
     switch(level)
     {
         case 0:
-            m_primaryLabel = label;
+            setLabels(label, m_secondaryLabel);
             break;
         case 1:
-            m_secondaryLabel = label;
+            setLabels(m_primaryLabel, label);
             break;
         default:
             ;
     }
 }
+
+void Component::setLabels(Label *primary, Label *secondary)
+{
+    if(m_primaryLabel == primary && m_secondaryLabel == secondary)
+        return;
+
+    Label *oldPrimary = m_primaryLabel;
+    Label *oldSecondary = m_secondaryLabel;
+    m_primaryLabel = primary;
+    m_secondaryLabel = secondary;
+    if(m_owner != 0)
+        m_owner->componentLabelsChanged(this, oldPrimary, oldSecondary);
+}
@@ -19,17 +19,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef COMPONENT_H
 #define COMPONENT_H
 
-#include <QObject>
+#include <QString>
+#include <QList>
+#include <QVector>
 
+#include "stock.h"
+
+class CO;
 class Datasheet;
 class Container;
 class Package;
-class Stock;
 class Label;
 
-class Component : public QObject
+// A plain record, owned by the CO it is added to. Renames and label
+// changes are reported straight to that CO, which keeps its indexes in
+// step. The ID is the component's handle: CO::findComponent(int) looks it
+// up in an array indexed by ID.
+class Component
 {
-    Q_OBJECT
 public:
     enum LabelLevel
     {
@@ -37,17 +44,18 @@ public:
         SecondaryLabel = 1
     };
 
-    explicit Component(const QString name, QObject *parent = 0);
+    explicit Component(const QString &name);
+    ~Component();
+
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
 
     int ID()
     {
         return m_ID;
     }
 
-    void setName(const QString &name)
-    {
-        m_name = name;
-    }
+    void setName(const QString &name);
     QString name()
     {
         return m_name;
@@ -77,10 +85,25 @@ public:
         return m_datasheets;
     }
 
-    void addStock(Stock *stock);
+    // Stocks are held by value. A Stock pointer stays valid until a stock
+    // is added to or removed from the component.
+    Stock *addStock(const Stock &stock);
     void removeStock(const QString &packageName);
     Stock *stock(const QString &packageName);
-    QList<Stock *> stocks();
+    Stock *stock(Package *package);
+    Stock *stockById(int packageId);    // by pooled package name ID
+
+    // The stock BOMs are booked against: the one whose package ranks first
+    // (see Package::order()), kept up to date by addStock() and removeStock()
+    Stock *bookingStock()
+    {
+        return (m_bookingStock >= 0) ? const_cast<Stock *>(&m_stocks.at(m_bookingStock)) : 0;
+    }
+
+    const QVector<Stock> &stocks()
+    {
+        return m_stocks;
+    }
 
     void setIgnoreStock(bool ignore)
     {
@@ -91,10 +114,8 @@ public:
         return m_ignoreStock;
     }
 
-    void setTotalStock(int total)
-    {
-        m_totalStock = total;
-    }
+    // Sum of the stocks, kept up to date by addStock(), removeStock() and
+    // Stock::setStock()
     int totalStock()
     {
         return m_totalStock;
@@ -110,11 +131,7 @@ public:
     }
 
     void setLabel(int level, Label *label);
-    void setLabels(Label *primary, Label *secondary)
-    {
-        m_primaryLabel = primary;
-        m_secondaryLabel = secondary;
-    }
+    void setLabels(Label *primary, Label *secondary);
     Label *primaryLabel()
     {
         return m_primaryLabel;
@@ -146,20 +163,23 @@ public:
         return m_linkedTo;
     }
 
+private:
+    Q_DISABLE_COPY(Component)
 
-signals:
-
-public slots:
+    friend class Stock;
+    friend class CO;
 
-private:
     static int nextID;
 
+    CO *m_owner;
     int m_ID;
     QString m_name;
     QString m_description;
     int m_defaultDatasheetIndex;
     QList<Datasheet *> m_datasheets;
-    QList<Stock *> m_stocks;
+    QVector<int> m_stockPackages;       // package name IDs, sorted
+    QVector<Stock> m_stocks;            // in the order of m_stockPackages
+    int m_bookingStock;                 // index in m_stocks, -1 if none
     bool m_ignoreStock;
     int m_lowStock;
     int m_totalStock;
@@ -169,6 +189,13 @@ private:
     QString m_notes;
 
     Component *m_linkedTo;
+
+    int stockIndex(int packageId);
+    void updateBookingStock();
+    void stockChanged(int delta)
+    {
+        m_totalStock += delta;
+    }
 };
 
 #endif // COMPONENT_H
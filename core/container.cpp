@@ -17,9 +17,10 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 **********************************************************************/
 
 #include "container.h"
+#include "namepool.h"
 
-Container::Container(const QString &name, QObject *parent) :
-    QObject(parent),
-    m_name(name)
+Container::Container(const QString &name) :
+    m_nameId(NamePool::intern(name)),
+    m_name(NamePool::name(m_nameId))
 {
 }
@@ -19,24 +19,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef CONTAINER_H
 #define CONTAINER_H
 
-#include <QObject>
+#include <QString>
 
-class Container : public QObject
+class Container
 {
-    Q_OBJECT
 public:
-    explicit Container(const QString &name, QObject *parent = 0);
+    explicit Container(const QString &name);
 
     QString name()
     {
         return m_name;
     }
-
-signals:
-
-public slots:
+    int nameId()
+    {
+        return m_nameId;
+    }
 
 private:
+    int m_nameId;
     QString m_name;
 
 };
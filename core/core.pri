@@ -0,0 +1,25 @@
+# Component Organizer
+# Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Included by the projects linking the core library
+
+INCLUDEPATH += $$PWD
+DEPENDPATH  += $$PWD
+
+LIBS += -L$$OUT_PWD/../core -lcomporg-core
+
+win32-msvc*:PRE_TARGETDEPS += $$OUT_PWD/../core/comporg-core.lib
+else:PRE_TARGETDEPS += $$OUT_PWD/../core/libcomporg-core.a
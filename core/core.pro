@@ -0,0 +1,89 @@
+# Component Organizer
+# Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+QT       += core gui
+
+TARGET = comporg-core
+TEMPLATE = lib
+CONFIG += staticlib
+
+DEFINES += QT_NO_DEBUG_OUTPUT
+DEFINES += QT_NO_DEBUG
+
+DESTDIR = $$OUT_PWD
+
+SOURCES += manufacturer.cpp \
+    datasheet.cpp \
+    container.cpp \
+    component.cpp \
+    applicationnote.cpp \
+    package.cpp \
+    stock.cpp \
+    label.cpp \
+    co.cpp \
+    zipreader.cpp \
+    spreadsheet.cpp \
+    bom.cpp \
+    journal.cpp \
+    snapshot.cpp \
+    searchindex.cpp \
+    smtprogram.cpp \
+    smttemplate.cpp \
+    smtprofilelibrary.cpp \
+    smtheadscheduler.cpp \
+    smtsequenceoptimizer.cpp \
+    smtpanel.cpp \
+    smtbatch.cpp \
+    bomdemand.cpp \
+    stockreservation.cpp \
+    shortageplanner.cpp \
+    stockledger.cpp \
+    xmlnames.cpp \
+    namepool.cpp
+
+HEADERS  += manufacturer.h \
+    datasheet.h \
+    container.h \
+    component.h \
+    applicationnote.h \
+    package.h \
+    stock.h \
+    co_defs.h \
+    label.h \
+    co.h \
+    zipreader.h \
+    spreadsheet.h \
+    bom.h \
+    journal.h \
+    snapshot.h \
+    searchindex.h \
+    smtprogram.h \
+    smttemplate.h \
+    smtprofilelibrary.h \
+    smtheadscheduler.h \
+    smtsequenceoptimizer.h \
+    smtpanel.h \
+    smtbatch.h \
+    bomdemand.h \
+    stockreservation.h \
+    shortageplanner.h \
+    stockledger.h \
+    recordpool.h \
+    xmlnames.h \
+    namepool.h
+
+OBJECTS_DIR =   _build/tmp/obj
+MOC_DIR =       _build/tmp/moc
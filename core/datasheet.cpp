@@ -17,9 +17,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 **********************************************************************/
 
 #include "datasheet.h"
+#include "recordpool.h"
 
 #include <QStringList>
 
+static RecordPool<Datasheet> pool;
+
 QString Datasheet::typeToString(Type type)
 {
     switch(type)
@@ -69,8 +72,19 @@ QStringList Datasheet::typeNames()
     return list;
 }
 
-Datasheet::Datasheet(const QString &path, QObject *parent) :
-    QObject(parent),
+Datasheet::Datasheet(const QString &path) :
+    m_type(Normal),
+    m_manufacturer(0),
     m_path(path)
 {
 }
+
+void *Datasheet::operator new(size_t size)
+{
+    return pool.allocate(size);
+}
+
+void Datasheet::operator delete(void *p, size_t size)
+{
+    pool.release(p, size);
+}
@@ -19,13 +19,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef DATASHEET_H
 #define DATASHEET_H
 
-#include <QObject>
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
 
 class Manufacturer;
 
-class Datasheet : public QObject
+class Datasheet
 {
-    Q_OBJECT
+    Q_DECLARE_TR_FUNCTIONS(Datasheet)
+
 public:
 
     enum Type
@@ -40,7 +43,10 @@ public:
     static QString typeToString(Type type);
     static Type typeFromString(QString str);
 
-    explicit Datasheet(const QString &path, QObject *parent = 0);
+    explicit Datasheet(const QString &path);
+
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
 
     void setType(Type type)
     {
@@ -67,10 +73,6 @@ public:
 
 
 
-signals:
-
-public slots:
-
 private:
     Type m_type;
     Manufacturer *m_manufacturer;
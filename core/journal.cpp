@@ -0,0 +1,189 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "journal.h"
+
+#include <QDataStream>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdio.h>
+#endif
+
+static const quint32 JournalMagic = 0x434f4a31; // "COJ1"
+static const int HeaderSize = 8;                // magic, generation
+static const int RecordHeaderSize = 6;          // length, checksum
+
+static quint32 readUInt32(const char *p)
+{
+    return ((quint32)(uchar)p[0] << 24) | ((quint32)(uchar)p[1] << 16) |
+           ((quint32)(uchar)p[2] << 8) | (quint32)(uchar)p[3];
+}
+
+Journal::Journal()
+{
+}
+
+// Opens the journal written against data.xml generation 'generation' and
+// returns its intact records. A missing journal, or one belonging to another
+// generation, is started over empty.
+bool Journal::open(const QString &filePath, quint32 generation, QList<Record> *records)
+{
+    close();
+    m_file.setFileName(filePath);
+
+    if(!m_file.open(QIODevice::ReadWrite))
+    {
+        qDebug() << "Unable to open journal:" << m_file.errorString();
+        return false;
+    }
+
+    QByteArray data = m_file.readAll();
+
+    if(data.size() < HeaderSize ||
+            readUInt32(data.constData()) != JournalMagic ||
+            readUInt32(data.constData() + 4) != generation)
+    {
+        m_file.close();
+        return create(filePath, generation);
+    }
+
+    int offset = HeaderSize;
+    while(offset + RecordHeaderSize <= data.size())
+    {
+        const char *p = data.constData() + offset;
+        quint32 length = readUInt32(p);
+        quint16 checksum = ((quint16)(uchar)p[4] << 8) | (uchar)p[5];
+
+        if(length > (quint32)(data.size() - offset - RecordHeaderSize) ||
+                qChecksum(p + RecordHeaderSize, length) != checksum)
+            break;
+
+        QDataStream stream(QByteArray::fromRawData(p + RecordHeaderSize, length));
+        stream.setVersion(QDataStream::Qt_4_7);
+        Record record;
+        stream >> record.type >> record.fields >> record.value;
+        records->append(record);
+
+        offset += RecordHeaderSize + length;
+    }
+
+    if(offset != data.size())
+    {
+        qDebug() << "journal: dropping" << data.size() - offset << "bytes of incomplete record";
+        m_file.resize(offset);
+    }
+
+    m_file.seek(offset);
+
+    return true;
+}
+
+bool Journal::create(const QString &filePath, quint32 generation)
+{
+    close();
+    m_file.setFileName(filePath);
+
+    if(!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        qDebug() << "Unable to create journal:" << m_file.errorString();
+        return false;
+    }
+
+    QDataStream stream(&m_file);
+    stream << JournalMagic << generation;
+
+    return m_file.flush() && sync(m_file);
+}
+
+void Journal::close()
+{
+    if(m_file.isOpen())
+        m_file.close();
+}
+
+// Writes all records with a single write and waits until they are on disk
+bool Journal::append(const QList<Record> &records)
+{
+    if(!m_file.isOpen())
+        return false;
+
+    QByteArray buffer;
+    QDataStream out(&buffer, QIODevice::WriteOnly);
+
+    foreach(const Record &record, records)
+    {
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_4_7);
+        stream << record.type << record.fields << record.value;
+
+        out << (quint32)payload.size() << qChecksum(payload.constData(), payload.size());
+        out.writeRawData(payload.constData(), payload.size());
+    }
+
+    if(m_file.write(buffer) != buffer.size())
+    {
+        qDebug() << "Unable to write journal:" << m_file.errorString();
+        return false;
+    }
+
+    return m_file.flush() && sync(m_file);
+}
+
+// QFile::flush() only hands the data to the OS
+bool Journal::sync(QFile &file)
+{
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return fsync(file.handle()) == 0;
+#endif
+}
+
+// Puts 'from' in the place of 'to' in a single step, so that 'to' is
+// always either the old or the new file, also across a crash. 'from' must
+// be closed and synced.
+bool Journal::replace(const QString &from, const QString &to)
+{
+#ifdef Q_OS_WIN
+    QString source = QDir::toNativeSeparators(QFileInfo(from).absoluteFilePath());
+    QString target = QDir::toNativeSeparators(QFileInfo(to).absoluteFilePath());
+    return MoveFileExW((const wchar_t *)source.utf16(), (const wchar_t *)target.utf16(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if(::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) != 0)
+        return false;
+
+    // The rename is only durable once the directory entry is
+    int dir = ::open(QFile::encodeName(QFileInfo(to).absolutePath()).constData(), O_RDONLY);
+    if(dir >= 0)
+    {
+        fsync(dir);
+        ::close(dir);
+    }
+    return true;
+#endif
+}
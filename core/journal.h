@@ -0,0 +1,83 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+// Append-only change log kept next to data.xml. Every record is framed as
+// [length][checksum][payload], so a record torn by a crash is detected and
+// cut off when the journal is opened again. The header carries the
+// generation of the data.xml the records apply to; a journal left over from
+// an older generation is discarded instead of being replayed twice.
+class Journal
+{
+public:
+    enum RecordType
+    {
+        ComponentUpdate = 1,        // fields: name, <component> fragment
+        ComponentRemove,            // fields: name
+        ComponentRename,            // fields: old name, new name
+        ApplicationNoteUpdate,      // fields: description, <appnote> fragment
+        ApplicationNoteRemove,      // fields: description
+        ApplicationNoteRename,      // fields: old description, new description
+        StockDelta,                 // fields: component, package; value: delta
+        StockBatch                  // fields: (component, package, delta)...; value: moves
+    };
+
+    struct Record
+    {
+        Record(quint8 type = 0, const QStringList &fields = QStringList(), qint32 value = 0) :
+            type(type), fields(fields), value(value)
+        {
+        }
+
+        quint8 type;
+        QStringList fields;
+        qint32 value;
+    };
+
+    Journal();
+
+    bool open(const QString &filePath, quint32 generation, QList<Record> *records);
+    bool create(const QString &filePath, quint32 generation);
+    void close();
+
+    bool isOpen() const
+    {
+        return m_file.isOpen();
+    }
+    qint64 size() const
+    {
+        return m_file.size();
+    }
+
+    bool append(const QList<Record> &records);
+
+    static bool sync(QFile &file);
+    static bool replace(const QString &from, const QString &to);
+
+private:
+    QFile m_file;
+};
+
+#endif // JOURNAL_H
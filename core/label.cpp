@@ -17,32 +17,52 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 **********************************************************************/
 
 #include "label.h"
+#include "recordpool.h"
+#include "namepool.h"
 
 #include <QDebug>
 
-Label::Label(const QString &name, Label *top, QList<Label *> leafs, QObject *parent) :
-    QObject(parent),
-    m_name(name),
-    m_top(top)
+static RecordPool<Label> pool;
+
+Label::Label(const QString &name, Label *top, QList<Label *> leafs) :
+    m_nameId(NamePool::intern(name)),
+    m_name(NamePool::name(m_nameId)),
+    m_top(top),
+    m_leafs(leafs)
 {
 }
 
+void *Label::operator new(size_t size)
+{
+    return pool.allocate(size);
+}
+
+void Label::operator delete(void *p, size_t size)
+{
+    pool.release(p, size);
+}
+
 void Label::removeLeaf(const QString &name)
 {
-    if(!m_leafs.isEmpty())
+    int id = NamePool::find(name);
+    if(id < 0)
+        return;
+
+    foreach(Label *leaf, m_leafs)
     {
-        foreach(Label *leaf, m_leafs)
-        {
-            if(leaf->name().compare(name) == 0)
-                m_leafs.removeOne(leaf);
-        }
+        if(leaf->nameId() == id)
+            m_leafs.removeOne(leaf);
     }
 }
 
 Label *Label::leaf(const QString &name)
 {
+    int id = NamePool::find(name);
+    if(id < 0)
+        return 0;
+
     foreach(Label *l, m_leafs)
-        if(l->name().compare(name) == 0)
+        if(l->nameId() == id)
             return l;
     return 0;
 }
@@ -19,18 +19,25 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef LABEL_H
 #define LABEL_H
 
-#include <QObject>
+#include <QString>
+#include <QList>
 
-class Label : public QObject
+class Label
 {
-    Q_OBJECT
 public:
-    explicit Label(const QString &name, Label *top = 0, QList<Label *> leafs = QList<Label *>(), QObject *parent = 0);
+    explicit Label(const QString &name, Label *top = 0, QList<Label *> leafs = QList<Label *>());
+
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
 
     QString name()
     {
         return m_name;
     }
+    int nameId()
+    {
+        return m_nameId;
+    }
 
     void setTop(Label *label)
     {
@@ -52,12 +59,9 @@ public:
     }
     Label *leaf(const QString &name);
 
-signals:
-
-public slots:
-
 private:
 
+    int           m_nameId;
     QString       m_name;
     Label        *m_top;
     QList<Label *> m_leafs;
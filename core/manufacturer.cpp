@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 **********************************************************************/
 
 #include "manufacturer.h"
+#include "namepool.h"
 
 #include <QStringList>
 
@@ -77,9 +78,9 @@ QStringList Manufacturer::defaultNames()
     return m_defaultNames;
 }
 
-Manufacturer::Manufacturer(const QString &name, QObject *parent) :
-    QObject(parent),
-    m_name(name)
+Manufacturer::Manufacturer(const QString &name) :
+    m_nameId(NamePool::intern(name)),
+    m_name(NamePool::name(m_nameId))
 {
 }
 
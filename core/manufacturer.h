@@ -19,28 +19,29 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef MANUFACTURER_H
 #define MANUFACTURER_H
 
-#include <QObject>
+#include <QString>
+#include <QStringList>
 
-class Manufacturer : public QObject
+class Manufacturer
 {
-    Q_OBJECT
 public:
     static QStringList defaultNames();
 
-    explicit Manufacturer(const QString &name, QObject *parent = 0);
+    explicit Manufacturer(const QString &name);
     QString name()
     {
         return m_name;
     }
+    int nameId()
+    {
+        return m_nameId;
+    }
 
 
-signals:
-
-public slots:
-
 private:
     const static QStringList m_defaultNames;
 
+    int m_nameId;
     QString m_name;
 };
 
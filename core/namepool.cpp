@@ -0,0 +1,71 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "namepool.h"
+
+#include <QHash>
+#include <QVector>
+#include <QReadWriteLock>
+
+namespace
+{
+
+QHash<QString, int> ids;
+QVector<QString> names;
+QReadWriteLock lock;
+
+}
+
+int NamePool::intern(const QString &name)
+{
+    {
+        QReadLocker locker(&lock);
+        QHash<QString, int>::const_iterator i = ids.constFind(name);
+        if(i != ids.constEnd())
+            return i.value();
+    }
+
+    QWriteLocker locker(&lock);
+    QHash<QString, int>::const_iterator i = ids.constFind(name);
+    if(i != ids.constEnd())
+        return i.value();
+
+    int id = names.count();
+    names.append(name);
+    ids.insert(name, id);
+
+    return id;
+}
+
+int NamePool::find(const QString &name)
+{
+    QReadLocker locker(&lock);
+    return ids.value(name, -1);
+}
+
+QString NamePool::name(int id)
+{
+    QReadLocker locker(&lock);
+    return names.value(id);
+}
+
+int NamePool::count()
+{
+    QReadLocker locker(&lock);
+    return names.count();
+}
@@ -0,0 +1,38 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef NAMEPOOL_H
+#define NAMEPOOL_H
+
+#include <QString>
+
+// Names repeated across a data set (packages, manufacturers, containers,
+// labels) are kept here once. Each distinct name gets an ID for the life
+// of the program, and every record holding that name shares the pooled
+// QString, so there is one buffer per name and equal names compare as
+// integers. Names are never dropped; a library has a few hundred of them.
+class NamePool
+{
+public:
+    static int intern(const QString &name);
+    static int find(const QString &name);   // -1 when never interned
+    static QString name(int id);
+    static int count();
+};
+
+#endif // NAMEPOOL_H
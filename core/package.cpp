@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 **********************************************************************/
 
 #include "package.h"
+#include "namepool.h"
 
 #include <QStringList>
 
@@ -63,8 +64,11 @@ QStringList Package::defaultNames()
     return m_defaultNames;
 }
 
-Package::Package(const QString &name, QObject *parent) :
-    QObject(parent),
-    m_name(name)
+int Package::nextOrder = 0;
+
+Package::Package(const QString &name) :
+    m_order(Package::nextOrder++),
+    m_nameId(NamePool::intern(name)),
+    m_name(NamePool::name(m_nameId))
 {
 }
@@ -19,27 +19,37 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef PACKAGE_H
 #define PACKAGE_H
 
-#include <QObject>
+#include <QString>
+#include <QStringList>
 
-class Package : public QObject
+// Packages are ranked by order(), the order they were created in, which
+// is the order CO lists them in: BOMs book against the stock of the
+// component whose package ranks first.
+class Package
 {
-    Q_OBJECT
 public:
     static QStringList defaultNames();
 
-    explicit Package(const QString &name, QObject *parent = 0);
+    explicit Package(const QString &name);
     QString name()
     {
         return m_name;
     }
-
-signals:
-
-public slots:
+    int nameId()
+    {
+        return m_nameId;
+    }
+    int order()
+    {
+        return m_order;
+    }
 
 private:
     const static QStringList m_defaultNames;
+    static int nextOrder;
 
+    int m_order;
+    int m_nameId;
     QString m_name;
 
 };
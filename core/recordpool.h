@@ -0,0 +1,106 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef RECORDPOOL_H
+#define RECORDPOOL_H
+
+#include <QtGlobal>
+#include <QList>
+#include <new>
+
+// Storage for the many small records a data set is made of (components,
+// datasheets, labels). Records are carved out of blocks of BlockSize, so
+// loading a large data.xml costs one allocation per block instead of one
+// per record, and the records of a data set lie close together. A deleted record's slot goes on a free list and is handed out
+// again, so a reload fills the blocks of the data set it replaces.
+//
+// Used through the class's own operator new / delete; sizes other than
+// sizeof(T) (a derived class) go to the global heap. Not thread safe:
+// records are only created and deleted on the GUI thread.
+template <typename T, int BlockSize = 256>
+class RecordPool
+{
+public:
+    RecordPool() :
+        m_free(0)
+    {
+    }
+    ~RecordPool()
+    {
+        foreach(Slot *block, m_blocks)
+            ::operator delete(block);
+    }
+
+    void *allocate(size_t size)
+    {
+        if(size != sizeof(T))
+            return ::operator new(size);
+
+        if(m_free == 0)
+            grow();
+
+        Slot *slot = m_free;
+        m_free = slot->next;
+        return slot;
+    }
+
+    void release(void *p, size_t size)
+    {
+        if(p == 0)
+            return;
+
+        if(size != sizeof(T))
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        Slot *slot = static_cast<Slot *>(p);
+        slot->next = m_free;
+        m_free = slot;
+    }
+
+private:
+    Q_DISABLE_COPY(RecordPool)
+
+    union Slot
+    {
+        Slot *next;
+        char data[sizeof(T)];
+        double alignDouble;
+        qint64 alignInt;
+        void *alignPointer;
+    };
+
+    Slot *m_free;
+    QList<Slot *> m_blocks;
+
+    void grow()
+    {
+        Slot *block = static_cast<Slot *>(::operator new(sizeof(Slot) * BlockSize));
+        m_blocks.append(block);
+
+        for(int i = BlockSize - 1; i >= 0; i--)
+        {
+            block[i].next = m_free;
+            m_free = &block[i];
+        }
+    }
+};
+
+#endif // RECORDPOOL_H
@@ -0,0 +1,237 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "searchindex.h"
+
+#include <QSet>
+#include <QtAlgorithms>
+
+namespace
+{
+
+struct Hit
+{
+    int id;
+    int score;
+};
+
+bool hitLessThan(const Hit &a, const Hit &b)
+{
+    if(a.score != b.score)
+        return a.score > b.score;
+    return a.id < b.id;
+}
+
+bool sizeLessThan(const QVector<int> *a, const QVector<int> *b)
+{
+    return a->size() < b->size();
+}
+
+}
+
+SearchIndex::SearchIndex()
+{
+}
+
+// Up to three UTF-16 units packed with their count, so "a", "ab" and "abc"
+// never collide
+quint64 SearchIndex::gram(const QChar *c, int length)
+{
+    quint64 key = (quint64) length << 48;
+    for(int i = 0; i < length; i++)
+        key |= (quint64) c[i].unicode() << (32 - 16 * i);
+    return key;
+}
+
+QVector<quint64> SearchIndex::grams(const QStringList &fields)
+{
+    QSet<quint64> set;
+
+    foreach(const QString &field, fields)
+    {
+        const QChar *c = field.constData();
+        for(int i = 0; i < field.size(); i++)
+            for(int length = 1; length <= 3 && i + length <= field.size(); length++)
+                set.insert(gram(c + i, length));
+    }
+
+    QVector<quint64> list;
+    list.reserve(set.count());
+    foreach(quint64 key, set)
+        list.append(key);
+    return list;
+}
+
+void SearchIndex::insert(int id, const QStringList &fields)
+{
+    remove(id);
+
+    Document document;
+    foreach(const QString &field, fields)
+        document.fields.append(field.toLower());
+    document.grams = grams(document.fields);
+
+    foreach(quint64 key, document.grams)
+    {
+        QVector<int> &posting = m_postings[key];
+        // IDs mostly grow, so this is usually an append
+        if(posting.isEmpty() || posting.last() < id)
+            posting.append(id);
+        else
+            posting.insert(qLowerBound(posting.begin(), posting.end(), id) - posting.begin(), id);
+    }
+
+    m_documents.insert(id, document);
+}
+
+void SearchIndex::remove(int id)
+{
+    QHash<int, Document>::iterator d = m_documents.find(id);
+    if(d == m_documents.end())
+        return;
+
+    foreach(quint64 key, d.value().grams)
+    {
+        QHash<quint64, QVector<int> >::iterator p = m_postings.find(key);
+        if(p == m_postings.end())
+            continue;
+
+        QVector<int> &posting = p.value();
+        QVector<int>::iterator i = qBinaryFind(posting.begin(), posting.end(), id);
+        if(i != posting.end())
+            posting.erase(i);
+        if(posting.isEmpty())
+            m_postings.erase(p);
+    }
+
+    m_documents.erase(d);
+}
+
+void SearchIndex::clear()
+{
+    m_documents.clear();
+    m_postings.clear();
+}
+
+// Returns the documents holding 'text', best matches first. The search
+// gives up, returning nothing, as soon as 'stop' becomes non-zero.
+QList<int> SearchIndex::search(const QString &text, const QAtomicInt *stop) const
+{
+    QList<int> result;
+    QString query = text.toLower();
+
+    if(query.isEmpty())
+        return result;
+
+    QVector<int> candidates;
+
+    if(query.size() <= 3)
+    {
+        // The posting list is the exact answer
+        candidates = m_postings.value(gram(query.constData(), query.size()));
+    }
+    else
+    {
+        QList<const QVector<int> *> postings;
+        for(int i = 0; i + 3 <= query.size(); i++)
+        {
+            QHash<quint64, QVector<int> >::const_iterator p = m_postings.constFind(gram(query.constData() + i, 3));
+            if(p == m_postings.constEnd())
+                return result;
+            postings.append(&p.value());
+        }
+
+        // Smallest list first keeps every intersection short
+        qSort(postings.begin(), postings.end(), sizeLessThan);
+
+        candidates = *postings.first();
+        for(int n = 1; n < postings.count() && !candidates.isEmpty(); n++)
+        {
+            if(stop != 0 && *stop != 0)
+                return result;
+
+            const QVector<int> &other = *postings.at(n);
+            QVector<int> common;
+            int i = 0;
+            int j = 0;
+            while(i < candidates.size() && j < other.size())
+            {
+                if(candidates.at(i) < other.at(j))
+                    i++;
+                else if(other.at(j) < candidates.at(i))
+                    j++;
+                else
+                {
+                    common.append(candidates.at(i));
+                    i++;
+                    j++;
+                }
+            }
+            candidates = common;
+        }
+    }
+
+    QVector<Hit> hits;
+    hits.reserve(candidates.size());
+
+    for(int i = 0; i < candidates.size(); i++)
+    {
+        if((i & 1023) == 0 && stop != 0 && *stop != 0)
+            return result;
+
+        int id = candidates.at(i);
+        int s = score(m_documents.value(id), query);
+        if(s > 0)
+        {
+            Hit hit = { id, s };
+            hits.append(hit);
+        }
+    }
+
+    qSort(hits.begin(), hits.end(), hitLessThan);
+
+    foreach(const Hit &hit, hits)
+        result.append(hit.id);
+
+    return result;
+}
+
+// 0 when no field contains the query (a trigram false positive). Earlier
+// fields weigh more, and a whole or leading match beats one in the middle.
+int SearchIndex::score(const Document &document, const QString &text) const
+{
+    int best = 0;
+
+    for(int i = 0; i < document.fields.count(); i++)
+    {
+        const QString &field = document.fields.at(i);
+        int position = field.indexOf(text);
+        if(position < 0)
+            continue;
+
+        int s = 3;
+        if(position == 0)
+            s = (field.size() == text.size()) ? 9 : 6;
+
+        s = s * (document.fields.count() - i) + 1;
+        if(s > best)
+            best = s;
+    }
+
+    return best;
+}
@@ -0,0 +1,74 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QVector>
+#include <QAtomicInt>
+
+// Inverted index answering "which documents contain this text", case
+// insensitive, like QString::contains(). Every 1, 2 and 3 character
+// sequence of a document points to the sorted list of documents holding
+// it; longer queries intersect the lists of their trigrams and confirm
+// the few candidates left. Documents are identified by an int and made of
+// fields, the first one weighing the most in the ranking.
+//
+// Copies share their data until one of them is modified, so a copy taken on
+// the GUI thread can be searched from another thread while the original
+// keeps being updated.
+class SearchIndex
+{
+public:
+    SearchIndex();
+
+    void insert(int id, const QStringList &fields);
+    void remove(int id);
+    void clear();
+
+    bool contains(int id) const
+    {
+        return m_documents.contains(id);
+    }
+    int count() const
+    {
+        return m_documents.count();
+    }
+
+    QList<int> search(const QString &text, const QAtomicInt *stop = 0) const;
+
+private:
+    struct Document
+    {
+        QStringList fields;         // lower case
+        QVector<quint64> grams;
+    };
+
+    QHash<int, Document> m_documents;
+    QHash<quint64, QVector<int> > m_postings;
+
+    static quint64 gram(const QChar *c, int length);
+    static QVector<quint64> grams(const QStringList &fields);
+    int score(const Document &document, const QString &text) const;
+};
+
+#endif // SEARCHINDEX_H
@@ -0,0 +1,97 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "shortageplanner.h"
+#include "stock.h"
+
+#include <QFile>
+#include <QTextStream>
+
+ShortagePlanner::ShortagePlanner(CO *co) :
+    m_parts(co),
+    m_productCount(0)
+{
+}
+
+// Adds the parts of 'boards' boards of a product
+void ShortagePlanner::addBom(const Bom &bom, int boards, const QString &product)
+{
+    m_productCount++;
+    m_parts.addBom(bom, boards, product);
+}
+
+void ShortagePlanner::clear()
+{
+    m_parts.clear();
+    m_productCount = 0;
+}
+
+// Every part of the plan, in order of first use, with current stock
+QList<ShortagePlanner::Demand> ShortagePlanner::demand() const
+{
+    QList<Demand> list;
+    foreach(const BomDemand::Part &part, m_parts.parts())
+    {
+        Demand demand;
+        demand.partNumber = part.partNumber;
+        demand.products = part.products;
+        demand.missing = (part.component == 0);
+        demand.required = part.quantity;
+        demand.available = (part.stock != 0) ? part.stock->stock() : 0;
+        list.append(demand);
+    }
+    return list;
+}
+
+// The parts to order: those missing from the library or short of stock
+QList<ShortagePlanner::Demand> ShortagePlanner::purchaseList() const
+{
+    QList<Demand> list;
+    foreach(const Demand &d, demand())
+        if(d.missing || d.toBuy() > 0)
+            list.append(d);
+    return list;
+}
+
+// Quoted as SpreadSheet::loadCsv() reads it back, when the text holds the
+// separator, a quote or a line break
+static QString csvField(const QString &text)
+{
+    if(!text.contains(';') && !text.contains('"') && !text.contains('\n') && !text.contains('\r'))
+        return text;
+
+    QString quoted = text;
+    quoted.replace("\"", "\"\"");
+    return '"' + quoted + '"';
+}
+
+bool ShortagePlanner::writeCsv(const QString &filePath, const QList<Demand> &list)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    stream << "Part;Required;Available;To buy;Missing;Products" << endl;
+    foreach(const Demand &d, list)
+        stream << csvField(d.partNumber) << ';' << d.required << ';' << d.available << ';' << d.toBuy() << ';'
+               << (d.missing ? "yes" : "no") << ';' << csvField(d.products.join(", ")) << endl;
+
+    return stream.status() == QTextStream::Ok;
+}
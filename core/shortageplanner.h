@@ -0,0 +1,74 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SHORTAGEPLANNER_H
+#define SHORTAGEPLANNER_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+#include "bomdemand.h"
+
+class CO;
+class Bom;
+
+// Demand of a build plan of several products, each a BOM built a number
+// of times, added up per part (see BomDemand) and compared with stock. Parts shared by
+// several products are checked against their total, which the per-BOM
+// check cannot do.
+class ShortagePlanner
+{
+    Q_DECLARE_TR_FUNCTIONS(ShortagePlanner)
+
+public:
+    struct Demand
+    {
+        QString partNumber;
+        QStringList products;   // products using the part, in plan order
+        bool missing;           // part not in the library
+        int required;
+        int available;
+
+        int toBuy() const
+        {
+            return qMax(required - qMax(available, 0), 0);
+        }
+    };
+
+    explicit ShortagePlanner(CO *co);
+
+    void addBom(const Bom &bom, int boards, const QString &product);
+    void clear();
+
+    int productCount() const
+    {
+        return m_productCount;
+    }
+    QList<Demand> demand() const;
+    QList<Demand> purchaseList() const;
+
+    static bool writeCsv(const QString &filePath, const QList<Demand> &list);
+
+private:
+    BomDemand m_parts;
+    int m_productCount;
+};
+
+#endif // SHORTAGEPLANNER_H
@@ -0,0 +1,204 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "smtbatch.h"
+#include "smtprogram.h"
+#include "smtpanel.h"
+#include "spreadsheet.h"
+
+#include <QtConcurrentMap>
+#include <QFileInfo>
+#include <QDir>
+#include <QFile>
+#include <QTextStream>
+#include <QSet>
+#include <QRegExp>
+
+SmtBatch::SmtBatch(SmtProfileLibrary *library) :
+    m_library(library),
+    m_optimizeSequence(false)
+{
+}
+
+bool SmtBatch::loadManifest(const QString &filePath)
+{
+    m_jobs.clear();
+    m_errorString.clear();
+
+    SpreadSheet sheet;
+    if(!sheet.load(filePath))
+    {
+        m_errorString = sheet.errorString();
+        return false;
+    }
+
+    QDir dir = QFileInfo(filePath).absoluteDir();
+    QSet<QString> names;
+
+    for(int row = 2; row <= sheet.rowCount(); row++)
+    {
+        Job job;
+        job.pcbName = sheet.cell(row, 1).trimmed();
+        if(job.pcbName.isEmpty())
+            continue;
+
+        // The name becomes the program's file name in the output directory
+        if(job.pcbName.contains(QRegExp("[/\\\\:*?\"<>|]")) || job.pcbName == "." || job.pcbName == "..")
+        {
+            m_errorString = job.pcbName + tr(" ->PCB name is not a valid file name....");
+            return false;
+        }
+
+        // Two rows with the same name would write the same program file,
+        // also when the names only differ in case on Windows and Mac OS.
+        // summary.txt is written next to the programs.
+        QString key = job.pcbName.toLower();
+        if(names.contains(key) || key == "summary")
+        {
+            m_errorString = job.pcbName + tr(" ->PCB name duplicated....");
+            return false;
+        }
+        names.insert(key);
+
+        QString bom = sheet.cell(row, 2).trimmed();
+        if(!bom.isEmpty())
+            job.bomPath = dir.absoluteFilePath(bom);
+        job.placePath = dir.absoluteFilePath(sheet.cell(row, 3).trimmed());
+        job.panel = sheet.cell(row, 4);
+
+        job.ok = false;
+        job.boards = 0;
+        job.placements = 0;
+        job.profiles = 0;
+        job.busiestHead = 0;
+        job.balance = 0;
+        job.travelBefore = 0;
+        job.travelAfter = 0;
+        m_jobs.append(job);
+    }
+
+    if(m_jobs.isEmpty())
+    {
+        m_errorString = tr("No PCB found in ") + filePath;
+        return false;
+    }
+
+    return true;
+}
+
+// Generates every program of the manifest; returns false if any of them
+// failed or the summary could not be written
+bool SmtBatch::run(const QString &outputDir)
+{
+    m_errorString.clear();
+
+    if(!QDir().mkpath(outputDir))
+    {
+        m_errorString = tr("Cannot create ") + outputDir;
+        return false;
+    }
+
+    QList<Task> tasks;
+    for(int n = 0; n < m_jobs.count(); n++)
+    {
+        Task task;
+        task.job = &m_jobs[n];
+        task.library = m_library;
+        task.optimizeSequence = m_optimizeSequence;
+        task.outputDir = outputDir;
+        tasks.append(task);
+    }
+
+    QtConcurrent::blockingMap(tasks, runTask);
+
+    bool ok = true;
+    foreach(const Job &job, m_jobs)
+        ok = ok && job.ok;
+
+    m_summaryPath = QDir(outputDir).absoluteFilePath("summary.txt");
+    QFile file(m_summaryPath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        m_errorString = tr("Cannot write ") + m_summaryPath;
+        return false;
+    }
+
+    QTextStream stream(&file);
+    foreach(const QString &line, summary())
+        stream << line << endl;
+
+    return ok;
+}
+
+void SmtBatch::runTask(Task &task)
+{
+    Job *job = task.job;
+
+    SmtPanel panel;
+    if(!panel.parse(job->panel, &job->errorString))
+        return;
+
+    SmtProgram program(task.library);
+    program.setOptimizeSequence(task.optimizeSequence);
+    program.setPanel(panel);
+
+    if(!program.generate(job->pcbName, job->placePath, job->bomPath))
+    {
+        job->errorString = program.errorString();
+        return;
+    }
+
+    job->outputPath = QDir(task.outputDir).absoluteFilePath(job->pcbName + ".txt");
+    if(!program.save(job->outputPath))
+    {
+        job->errorString = tr("Write file error!");
+        return;
+    }
+
+    job->ok = true;
+    job->boards = panel.boardCount();
+    job->placements = program.placements().count();
+    job->profiles = program.profileNames().count();
+    job->busiestHead = program.headSchedule().maximumLoad();
+    job->balance = program.headSchedule().balance();
+    job->travelBefore = program.travelBefore();
+    job->travelAfter = program.travelAfter();
+}
+
+QStringList SmtBatch::summary() const
+{
+    QStringList lines;
+    int failed = 0;
+
+    foreach(const Job &job, m_jobs)
+    {
+        if(job.ok)
+            lines.append(tr("%1: %2 placements on %3 boards, %4 profiles, busiest head %5 (balance %6%), travel %7 -> %8")
+                         .arg(job.pcbName).arg(job.placements).arg(job.boards).arg(job.profiles)
+                         .arg(job.busiestHead).arg(job.balance)
+                         .arg(job.travelBefore, 0, 'f', 1).arg(job.travelAfter, 0, 'f', 1));
+        else
+        {
+            lines.append(tr("%1: FAILED, %2").arg(job.pcbName).arg(job.errorString));
+            failed++;
+        }
+    }
+
+    lines.append(tr("%1 programs, %2 failed").arg(m_jobs.count()).arg(failed));
+    return lines;
+}
@@ -0,0 +1,107 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SMTBATCH_H
+#define SMTBATCH_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+class SmtProfileLibrary;
+
+// Generates the SMT programs of a manifest in one run. The manifest is a
+// .xlsx or .csv sheet with a header row and one program per row:
+//
+//      A = PCB name, B = BOM file (may be empty), C = place file,
+//      D = panel definition (optional, see SmtPanel)
+//
+// Relative paths are taken from the manifest's directory. The programs
+// share one profile library and are generated in parallel; each is saved
+// as <PCB name>.txt in the output directory, next to a summary.txt. PCB
+// names must be plain file names, unique regardless of case.
+class SmtBatch
+{
+    Q_DECLARE_TR_FUNCTIONS(SmtBatch)
+
+public:
+    struct Job
+    {
+        QString pcbName;
+        QString bomPath;
+        QString placePath;
+        QString panel;
+
+        // Results
+        bool ok;
+        QString errorString;
+        QString outputPath;
+        int boards;
+        int placements;
+        int profiles;
+        int busiestHead;
+        int balance;
+        double travelBefore;
+        double travelAfter;
+    };
+
+    explicit SmtBatch(SmtProfileLibrary *library);
+
+    void setOptimizeSequence(bool optimize)
+    {
+        m_optimizeSequence = optimize;
+    }
+
+    bool loadManifest(const QString &filePath);
+    bool run(const QString &outputDir);
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+    QList<Job> jobs() const
+    {
+        return m_jobs;
+    }
+    QString summaryPath() const
+    {
+        return m_summaryPath;
+    }
+    QStringList summary() const;
+
+private:
+    // Everything a worker thread needs, so that it can be mapped
+    struct Task
+    {
+        Job *job;
+        SmtProfileLibrary *library;
+        bool optimizeSequence;
+        QString outputDir;
+    };
+
+    SmtProfileLibrary *m_library;
+    bool m_optimizeSequence;
+    QList<Job> m_jobs;
+    QString m_errorString;
+    QString m_summaryPath;
+
+    static void runTask(Task &task);
+};
+
+#endif // SMTBATCH_H
@@ -0,0 +1,203 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "smtheadscheduler.h"
+
+SmtHeadScheduler::SmtHeadScheduler() :
+    m_loads(HeadCount, 0),
+    m_roundRobinMaximum(0)
+{
+}
+
+void SmtHeadScheduler::clear()
+{
+    m_heads.clear();
+    m_loads.fill(0, HeadCount);
+    m_roundRobinMaximum = 0;
+}
+
+// The profiles with the fewest allowed heads are placed first, each
+// placement on the least loaded head it may use. Whatever imbalance is
+// left is then removed by moving placements along chains of heads: from
+// a busiest head to one holding at least two less, through heads that
+// share a profile. When no such chain exists the maximum load is minimal.
+void SmtHeadScheduler::schedule(const QVector<int> &placementProfiles, const QVector<quint8> &profileMasks)
+{
+    clear();
+
+    int profileCount = profileMasks.size();
+    QVector<int> placementCount(profileCount, 0);
+    foreach(int profile, placementProfiles)
+        placementCount[profile]++;
+
+    // What the old round robin over each profile's heads would have done
+    QVector<int> roundRobin(HeadCount, 0);
+    for(int profile = 0; profile < profileCount; profile++)
+    {
+        quint8 mask = allowedHeads(profileMasks.at(profile));
+        QVector<int> heads;
+        for(int h = 0; h < HeadCount; h++)
+            if(mask & (1 << h))
+                heads.append(h);
+        for(int n = 0; n < placementCount.at(profile); n++)
+            roundRobin[heads.at(n % heads.size())]++;
+    }
+    foreach(int load, roundRobin)
+        m_roundRobinMaximum = qMax(m_roundRobinMaximum, load);
+
+    // count[profile * HeadCount + head] = placements of profile on head
+    QVector<int> count(profileCount * HeadCount, 0);
+
+    QVector<int> order;
+    for(int width = 1; width <= HeadCount; width++)
+        for(int profile = 0; profile < profileCount; profile++)
+        {
+            quint8 mask = allowedHeads(profileMasks.at(profile));
+            int bits = 0;
+            for(int h = 0; h < HeadCount; h++)
+                if(mask & (1 << h))
+                    bits++;
+            if(bits == width)
+                order.append(profile);
+        }
+
+    foreach(int profile, order)
+    {
+        quint8 mask = allowedHeads(profileMasks.at(profile));
+        for(int n = 0; n < placementCount.at(profile); n++)
+        {
+            int best = -1;
+            for(int h = 0; h < HeadCount; h++)
+                if((mask & (1 << h)) && (best < 0 || m_loads.at(h) < m_loads.at(best)))
+                    best = h;
+            count[profile * HeadCount + best]++;
+            m_loads[best]++;
+        }
+    }
+
+    bool moved = true;
+    while(moved)
+    {
+        moved = false;
+        int maximum = maximumLoad();
+
+        for(int start = 0; start < HeadCount && !moved; start++)
+        {
+            if(m_loads.at(start) != maximum)
+                continue;
+
+            // Breadth first over heads; via[h] is the profile moved into h
+            QVector<int> from(HeadCount, -1);
+            QVector<int> via(HeadCount, -1);
+            QVector<int> queue;
+            queue.append(start);
+            from[start] = start;
+
+            int target = -1;
+            for(int q = 0; q < queue.size() && target < 0; q++)
+            {
+                int h = queue.at(q);
+                for(int profile = 0; profile < profileCount && target < 0; profile++)
+                {
+                    if(count.at(profile * HeadCount + h) == 0)
+                        continue;
+                    quint8 mask = allowedHeads(profileMasks.at(profile));
+                    for(int g = 0; g < HeadCount; g++)
+                    {
+                        if(!(mask & (1 << g)) || from.at(g) >= 0)
+                            continue;
+                        from[g] = h;
+                        via[g] = profile;
+                        if(m_loads.at(g) <= maximum - 2)
+                        {
+                            target = g;
+                            break;
+                        }
+                        queue.append(g);
+                    }
+                }
+            }
+
+            if(target < 0)
+                continue;
+
+            m_loads[start]--;
+            m_loads[target]++;
+            for(int g = target; g != start; g = from.at(g))
+            {
+                count[via.at(g) * HeadCount + g]++;
+                count[via.at(g) * HeadCount + from.at(g)]--;
+            }
+            moved = true;
+        }
+    }
+
+    // Placements of a profile take its heads in turn, as far as their
+    // counts go
+    QVector<int> next(profileCount, 0);
+    m_heads.resize(placementProfiles.size());
+    for(int n = 0; n < placementProfiles.size(); n++)
+    {
+        int profile = placementProfiles.at(n);
+        int h = next.at(profile);
+        while(count.at(profile * HeadCount + h) == 0)
+            h = (h + 1) % HeadCount;
+        count[profile * HeadCount + h]--;
+        m_heads[n] = h;
+        next[profile] = (h + 1) % HeadCount;
+    }
+}
+
+int SmtHeadScheduler::maximumLoad() const
+{
+    int maximum = 0;
+    foreach(int load, m_loads)
+        maximum = qMax(maximum, load);
+    return maximum;
+}
+
+// Average load of the heads in use against the busiest one, in percent;
+// 100 means every used head finishes at the same time
+int SmtHeadScheduler::balance() const
+{
+    int total = 0;
+    int used = 0;
+    foreach(int load, m_loads)
+    {
+        total += load;
+        if(load)
+            used++;
+    }
+
+    if(!used)
+        return 100;
+    return (total * 100) / (used * maximumLoad());
+}
+
+QStringList SmtHeadScheduler::report() const
+{
+    QStringList lines;
+    for(int h = 0; h < HeadCount; h++)
+        if(m_loads.at(h))
+            lines.append(tr("Head %1: %2 placements").arg(h + 1).arg(m_loads.at(h)));
+
+    lines.append(tr("Busiest head: %1 placements (round robin: %2)")
+                 .arg(maximumLoad()).arg(m_roundRobinMaximum));
+    lines.append(tr("Cycle time balance: %1%").arg(balance()));
+    return lines;
+}
@@ -0,0 +1,71 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SMTHEADSCHEDULER_H
+#define SMTHEADSCHEDULER_H
+
+#include <QCoreApplication>
+#include <QVector>
+#include <QStringList>
+
+// Spreads the placements of a program over the mounter heads. Each profile
+// allows a set of heads (bit n-1 of its mask for head n, an empty mask
+// meaning head 1) and the busiest head sets the cycle time, so placements
+// are assigned to keep the highest head load as low as the masks allow.
+class SmtHeadScheduler
+{
+    Q_DECLARE_TR_FUNCTIONS(SmtHeadScheduler)
+
+public:
+    enum { HeadCount = 8 };
+
+    SmtHeadScheduler();
+
+    void schedule(const QVector<int> &placementProfiles, const QVector<quint8> &profileMasks);
+    void clear();
+
+    // Head index (0 = head 1) of a placement
+    int head(int placement) const
+    {
+        return m_heads.at(placement);
+    }
+    int load(int head) const
+    {
+        return m_loads.at(head);
+    }
+    int maximumLoad() const;
+    int roundRobinMaximumLoad() const
+    {
+        return m_roundRobinMaximum;
+    }
+    int balance() const;
+
+    QStringList report() const;
+
+private:
+    QVector<int> m_heads;
+    QVector<int> m_loads;
+    int m_roundRobinMaximum;
+
+    static quint8 allowedHeads(quint8 mask)
+    {
+        return mask ? mask : 1;
+    }
+};
+
+#endif // SMTHEADSCHEDULER_H
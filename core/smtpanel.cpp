@@ -0,0 +1,155 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "smtpanel.h"
+
+#include <QStringList>
+#include <QRegExp>
+#include <qmath.h>
+
+SmtPanel::SmtPanel() :
+    m_rows(1),
+    m_columns(1),
+    m_hasBadMark(false)
+{
+}
+
+bool SmtPanel::parse(const QString &definition, QString *errorString)
+{
+    *this = SmtPanel();
+
+    QStringList words = definition.simplified().split(' ', QString::SkipEmptyParts);
+    if(words.isEmpty())
+        return true;
+
+    QRegExp size("(\\d+)[xX](\\d+)");
+    if(!size.exactMatch(words.takeFirst()))
+    {
+        *errorString = tr("Panel must start with <rows>x<columns>");
+        return false;
+    }
+    m_rows = size.cap(1).toInt();
+    m_columns = size.cap(2).toInt();
+    if(m_rows < 1 || m_columns < 1)
+    {
+        *errorString = tr("Panel needs at least one row and column");
+        return false;
+    }
+
+    foreach(const QString &word, words)
+    {
+        QString key = word.section('=', 0, 0).toLower();
+        QString value = word.section('=', 1);
+
+        if(key == "pitch" && parsePoint(value, &m_pitch))
+            continue;
+        if(key == "size" && parsePoint(value, &m_size) && m_size.x() > 0 && m_size.y() > 0)
+            continue;
+        if(key == "badmark" && parsePoint(value, &m_badMark))
+        {
+            m_hasBadMark = true;
+            continue;
+        }
+        if(key == "rotation")
+        {
+            bool ok = true;
+            foreach(const QString &angle, value.split(','))
+            {
+                int degrees = angle.toInt(&ok);
+                if(!ok)
+                    break;
+                m_rotations.append(((degrees % 360) + 360) % 360);
+            }
+            if(ok)
+                continue;
+        }
+
+        *errorString = tr("Wrong panel setting: %1").arg(word);
+        return false;
+    }
+
+    // Without a step the boards would all land on top of each other
+    if((m_columns > 1 && m_pitch.x() == 0) || (m_rows > 1 && m_pitch.y() == 0))
+    {
+        *errorString = tr("Panel of several boards needs a pitch=<x>,<y> for its rows and columns");
+        return false;
+    }
+
+    if(m_size.isNull())
+        m_size = m_pitch;
+
+    // The board is turned about its centre, which the size gives
+    foreach(int rotation, m_rotations)
+        if(rotation != 0 && (m_size.x() <= 0 || m_size.y() <= 0))
+        {
+            *errorString = tr("Rotated boards need a size=<w>,<h> (or a pitch along both directions)");
+            return false;
+        }
+
+    return true;
+}
+
+bool SmtPanel::parsePoint(const QString &text, QPointF *point)
+{
+    QStringList values = text.split(',');
+    if(values.count() != 2)
+        return false;
+
+    bool okX, okY;
+    point->setX(values.at(0).toDouble(&okX));
+    point->setY(values.at(1).toDouble(&okY));
+    return okX && okY;
+}
+
+bool SmtPanel::isSingleBoard() const
+{
+    return boardCount() == 1 && boardRotation(0) == 0 && !m_hasBadMark;
+}
+
+int SmtPanel::boardRotation(int board) const
+{
+    if(m_rotations.isEmpty())
+        return 0;
+    return m_rotations.at(board % m_rotations.count());
+}
+
+// Board coordinates to panel coordinates. A turned board keeps its centre,
+// so it covers the same pitch cell as an unturned one.
+QPointF SmtPanel::map(int board, const QPointF &point) const
+{
+    QPointF origin((board % m_columns) * m_pitch.x(), (board / m_columns) * m_pitch.y());
+    QPointF centre = m_size / 2;
+    QPointF p = point - centre;
+
+    switch(boardRotation(board))
+    {
+        case 0:
+            return origin + point;
+        case 90:
+            return origin + centre + QPointF(-p.y(), p.x());
+        case 180:
+            return origin + centre - p;
+        case 270:
+            return origin + centre + QPointF(p.y(), -p.x());
+    }
+
+    double angle = boardRotation(board) * M_PI / 180;
+    double c = qCos(angle);
+    double s = qSin(angle);
+    return origin + centre + QPointF(p.x() * c - p.y() * s, p.x() * s + p.y() * c);
+}
@@ -0,0 +1,87 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SMTPANEL_H
+#define SMTPANEL_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QList>
+#include <QPointF>
+
+// Step and repeat definition of a panel of identical boards, written as
+//
+//      <rows>x<columns> [pitch=<x>,<y>] [size=<w>,<h>] [rotation=<a>,<b>,...]
+//      [badmark=<x>,<y>]
+//
+// e.g. "2x4 pitch=60,45 rotation=0,180 badmark=3,2.5". Boards are numbered
+// row by row from the panel origin, the board origin of board (r, c)
+// landing at (c * pitch x, r * pitch y); the pitch is required along every
+// direction with more than one board. Each board is turned by its rotation
+// in degrees about the centre of the board, so that it stays in its pitch
+// cell; the board size defaults to the pitch. The rotation list is
+// repeated when it is shorter than the number of boards. The bad mark is
+// given in board coordinates and repeated on every board.
+class SmtPanel
+{
+    Q_DECLARE_TR_FUNCTIONS(SmtPanel)
+
+public:
+    SmtPanel();
+
+    bool parse(const QString &definition, QString *errorString);
+
+    int rows() const
+    {
+        return m_rows;
+    }
+    int columns() const
+    {
+        return m_columns;
+    }
+    int boardCount() const
+    {
+        return m_rows * m_columns;
+    }
+    bool isSingleBoard() const;
+
+    int boardRotation(int board) const;
+    QPointF map(int board, const QPointF &point) const;
+
+    bool hasBadMark() const
+    {
+        return m_hasBadMark;
+    }
+    QPointF badMark() const
+    {
+        return m_badMark;
+    }
+
+private:
+    int m_rows;
+    int m_columns;
+    QPointF m_pitch;
+    QPointF m_size;
+    QList<int> m_rotations;
+    bool m_hasBadMark;
+    QPointF m_badMark;
+
+    static bool parsePoint(const QString &text, QPointF *point);
+};
+
+#endif // SMTPANEL_H
@@ -0,0 +1,180 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "smtprofilelibrary.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+// Profile text with its number written over the one in the file
+QString SmtProfile::text(int number) const
+{
+    QString first = header;
+
+    if(number < 10)
+        first.replace(5, 1, QString::number(number));
+    else if(number < 100)
+        first.replace(4, 2, QString::number(number));
+    else
+        first.replace(3, 3, QString::number(number));
+
+    return first + body;
+}
+
+SmtProfileLibrary::SmtProfileLibrary(const QString &directory) :
+    m_directory(directory),
+    m_templateSize(-1),
+    m_fileReads(0)
+{
+}
+
+void SmtProfileLibrary::setDirectory(const QString &directory)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(m_directory == directory)
+        return;
+
+    m_directory = directory;
+    m_profiles.clear();
+    m_template.clear();
+    m_templateSize = -1;
+}
+
+void SmtProfileLibrary::clear()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_profiles.clear();
+    m_template.clear();
+    m_templateSize = -1;
+}
+
+bool SmtProfileLibrary::profile(const QString &partNumber, SmtProfile *profile, QString *errorString)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QFileInfo info(m_directory + '/' + partNumber + ".txt");
+
+    QHash<QString, Entry>::const_iterator i = m_profiles.constFind(partNumber);
+    if(i != m_profiles.constEnd() && info.exists() &&
+            i.value().modified == info.lastModified() && i.value().size == info.size())
+    {
+        *profile = i.value().profile;
+        return true;
+    }
+
+    m_profiles.remove(partNumber);
+
+    Entry entry;
+    if(!readProfile(partNumber, &entry.profile, errorString))
+        return false;
+
+    entry.modified = info.lastModified();
+    entry.size = info.size();
+    m_profiles.insert(partNumber, entry);
+
+    *profile = entry.profile;
+    return true;
+}
+
+bool SmtProfileLibrary::boardTemplate(SmtTemplate *boardTemplate, QString *errorString)
+{
+    QMutexLocker locker(&m_mutex);
+
+    QFileInfo info(m_directory + "/board_temp.txt");
+
+    if(m_templateSize < 0 || !info.exists() ||
+            m_templateModified != info.lastModified() || m_templateSize != info.size())
+    {
+        m_fileReads++;
+        if(!m_template.load(info.filePath()))
+        {
+            m_templateSize = -1;
+            *errorString = "temp file error";
+            return false;
+        }
+        m_templateModified = info.lastModified();
+        m_templateSize = info.size();
+    }
+
+    *boardTemplate = m_template;
+    return true;
+}
+
+bool SmtProfileLibrary::readProfile(const QString &partNumber, SmtProfile *profile, QString *errorString)
+{
+    QFile file(m_directory + '/' + partNumber + ".txt");
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        *errorString = partNumber + ".txt file read error!";
+        return false;
+    }
+
+    m_fileReads++;
+    QString text = file.readAll();
+    file.close();
+
+    int point = text.indexOf("HEAD");
+    if(point == -1)
+    {
+        *errorString = partNumber + ".txt file missing head info!";
+        return false;
+    }
+
+    int end = text.indexOf('\n');
+    if(end < 0)
+        end = text.size();
+    profile->header = text.left(end);
+    profile->body = text.mid(end);
+
+    QStringList lines = profile->body.split('\n');
+    lines.removeFirst();    // rest of the header line
+    if(!lines.isEmpty())
+        profile->name = lines.takeFirst().trimmed();
+
+    // The heads are the digits of the first "HEAD..." word
+    profile->heads.clear();
+    profile->headMask = 0;
+    while(point < text.size() && text.at(point) != ' ')
+    {
+        QChar c = text.at(point);
+        if(c >= '1' && c <= '8')
+        {
+            profile->heads.append(c);
+            profile->headMask |= 1 << (c.unicode() - '1');
+        }
+        point++;
+    }
+
+    profile->rows.clear();
+    bool afterHead = false;
+    foreach(const QString &line, lines)
+    {
+        if(afterHead)
+        {
+            if(!line.trimmed().isEmpty())
+                profile->rows.append(line);
+        }
+        else if(line.startsWith("HEAD"))
+            afterHead = true;
+    }
+
+    return true;
+}
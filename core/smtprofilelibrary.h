@@ -0,0 +1,92 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SMTPROFILELIBRARY_H
+#define SMTPROFILELIBRARY_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QDateTime>
+#include <QMutex>
+
+#include "smttemplate.h"
+
+// Feeder profile (<part>.txt) parsed into its parts. The first line holds
+// the profile number, rewritten for each program by text().
+struct SmtProfile
+{
+    QString header;         // "&F   0=...", number at columns 3-5
+    QString name;           // part name, second line
+    QString heads;          // head digits allowed, from the "HEAD-..." line
+    quint8 headMask;        // bit n-1 set for head n
+    QStringList rows;       // numeric rows following the head line
+    QString body;           // everything after the header, as read
+
+    QString text(int number) const;
+};
+
+// Profiles and board template of one profile directory, read once and
+// kept in memory. Every lookup compares the file's modification time and
+// size with the cached copy, so an edited profile is read again while an
+// unchanged one costs no file read. Lookups may come from several threads.
+class SmtProfileLibrary
+{
+    Q_DECLARE_TR_FUNCTIONS(SmtProfileLibrary)
+
+public:
+    explicit SmtProfileLibrary(const QString &directory = QString());
+
+    void setDirectory(const QString &directory);
+    QString directory() const
+    {
+        return m_directory;
+    }
+
+    bool profile(const QString &partNumber, SmtProfile *profile, QString *errorString);
+    bool boardTemplate(SmtTemplate *boardTemplate, QString *errorString);
+
+    void clear();
+    int fileReads() const
+    {
+        return m_fileReads;
+    }
+
+private:
+    struct Entry
+    {
+        SmtProfile profile;
+        QDateTime modified;
+        qint64 size;
+    };
+
+    QString m_directory;
+    QHash<QString, Entry> m_profiles;
+
+    SmtTemplate m_template;
+    QDateTime m_templateModified;
+    qint64 m_templateSize;
+
+    int m_fileReads;
+    mutable QMutex m_mutex;
+
+    bool readProfile(const QString &partNumber, SmtProfile *profile, QString *errorString);
+};
+
+#endif // SMTPROFILELIBRARY_H
@@ -0,0 +1,501 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "smtprogram.h"
+#include "spreadsheet.h"
+#include "smtprofilelibrary.h"
+#include "smtsequenceoptimizer.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+#include <QRegExp>
+#include <QSet>
+#include <qmath.h>
+
+SmtProgram::SmtProgram(SmtProfileLibrary *library) :
+    m_library(library),
+    m_withBom(false),
+    m_optimizeSequence(false),
+    m_travelBefore(0),
+    m_travelAfter(0)
+{
+}
+
+// Builds the program text; on failure errorString() tells why. Without a
+// BOM file the part numbers are read from the place file.
+bool SmtProgram::generate(const QString &pcbName, const QString &placeFilePath, const QString &bomFilePath)
+{
+    m_errorString.clear();
+    m_bomPartNumbers.clear();
+    m_designatorRow.clear();
+    m_placements.clear();
+    m_profileNames.clear();
+    m_profileIndex.clear();
+    m_profileHeadMasks.clear();
+    m_headSchedule.clear();
+    m_travelBefore = 0;
+    m_travelAfter = 0;
+    m_program.clear();
+
+    m_withBom = !bomFilePath.isEmpty();
+
+    if(m_withBom && !readBom(bomFilePath))
+        return false;
+
+    if(!readPlacements(placeFilePath, !m_withBom))
+        return false;
+
+    if(!m_library->boardTemplate(&m_program, &m_errorString))
+        return false;
+    if(!m_program.hasSection("End_of_FD") || !m_program.hasSection("&B.OPT"))
+    {
+        m_errorString = "temp file cannot find End_of_FD or &B.OPT!";
+        return false;
+    }
+    if(m_panel.hasBadMark() && !m_program.hasSection("&B.DSP"))
+    {
+        m_errorString = "temp file cannot find &B.DSP!";
+        return false;
+    }
+
+    if(!assignPartNumbers())
+        return false;
+
+    if(!expandPanel())
+        return false;
+
+    if(m_program.replaceField("PCBNAME=", pcbName) == false)
+    {
+        m_errorString = "temp file cannot read PCBNAME!";
+        return false;
+    }
+
+    if(!writePlacements())
+        return false;
+
+    writeBadMarks();
+    return true;
+}
+
+bool SmtProgram::save(const QString &filePath) const
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream stream(&file);
+    m_program.write(stream);
+    stream << endl;
+    return stream.status() == QTextStream::Ok;
+}
+
+bool SmtProgram::readBom(const QString &filePath)
+{
+    SpreadSheet sheet;
+    if(!sheet.load(filePath))
+    {
+        m_errorString = sheet.errorString();
+        return false;
+    }
+
+    QSet<QString> partNumbers;
+
+    for(int row = 2; row <= sheet.rowCount(); row++)
+    {
+        QString partNumber = sheet.cell(row, 1);
+        QString designators = sheet.cell(row, 3);
+        if(designators == "")
+            break;
+
+        if(partNumbers.contains(partNumber))
+        {
+            m_errorString = partNumber + " ->ERP Number duplicated....";
+            return false;
+        }
+        partNumbers.insert(partNumber);
+        m_bomPartNumbers.append(partNumber);
+
+        // A designator listed on two rows would have two part numbers
+        foreach(const QString &designator, expandDesignators(designators))
+        {
+            if(m_designatorRow.contains(designator))
+            {
+                m_errorString = designator + " ->Designator duplicated....";
+                return false;
+            }
+            m_designatorRow.insert(designator, m_bomPartNumbers.count() - 1);
+        }
+    }
+
+    return true;
+}
+
+// "R1, R2-R4" -> R1 R2 R3 R4, and "R01-R03" -> R01 R02 R03. Only a range
+// with the same prefix on both sides and a rising number is expanded;
+// anything else, such as the single designator "U1-2", is kept as
+// written, spaces removed.
+QStringList SmtProgram::expandDesignators(const QString &cell)
+{
+    QStringList designators;
+    QRegExp range("([^0-9]+)([0-9]+)-([^0-9]+)([0-9]+)");
+
+    foreach(QString str, cell.split(',', QString::SkipEmptyParts))
+    {
+        str.replace(" ", "");
+        if(str.isEmpty())
+            continue;
+
+        if(range.exactMatch(str) && range.cap(3) == range.cap(1))
+        {
+            QString prefix = range.cap(1);
+            int first = range.cap(2).toInt();
+            int last = range.cap(4).toInt();
+
+            // Zero padded numbers keep the width of the first one
+            int width = range.cap(2).startsWith('0') ? range.cap(2).length() : 0;
+
+            if(first < last && last - first < 10000)
+            {
+                for(int n = first; n <= last; n++)
+                    designators.append(prefix + QString("%1").arg(n, width, 10, QChar('0')));
+                continue;
+            }
+        }
+
+        designators.append(str);
+    }
+
+    return designators;
+}
+
+bool SmtProgram::readPlacements(const QString &filePath, bool withPartNumbers)
+{
+    SpreadSheet sheet;
+    if(!sheet.load(filePath))
+    {
+        m_errorString = sheet.errorString();
+        return false;
+    }
+
+    for(int row = 2; row <= sheet.rowCount(); row++)
+    {
+        Placement p;
+        p.x = sheet.cell(row, 1);
+        if(p.x == "")
+            break;
+
+        p.y = sheet.cell(row, 2);
+        p.rotation = sheet.cell(row, 3);
+        p.designator = sheet.cell(row, 4);
+        if(withPartNumbers)
+            p.partNumber = sheet.cell(row, 5);
+        m_placements.append(p);
+    }
+
+    return true;
+}
+
+// Gives every placement its part number and loads the profiles, in order of
+// first use
+bool SmtProgram::assignPartNumbers()
+{
+    if(m_withBom)
+    {
+        QStringList unmatched;
+        for(int n = 0; n < m_placements.count(); n++)
+        {
+            Placement &p = m_placements[n];
+            int row = m_designatorRow.value(p.designator, -1);
+            if(row < 0)
+                unmatched.append(p.designator);
+            else
+                p.partNumber = m_bomPartNumbers.at(row);
+        }
+
+        if(!unmatched.isEmpty())
+        {
+            m_errorString = unmatched.join(", ") + " -> Missing PLACE Designator on the BOM File!";
+            return false;
+        }
+    }
+
+    for(int n = 0; n < m_placements.count(); n++)
+    {
+        const Placement &p = m_placements.at(n);
+
+        if(p.partNumber == "")
+        {
+            m_errorString = "ERROR Missing ERP Number;\n" + p.designator;
+            return false;
+        }
+
+        if(!addProfile(p.partNumber))
+            return false;
+    }
+
+    return true;
+}
+
+// Inserts the part's profile in the template, numbered in order of use
+bool SmtProgram::addProfile(const QString &partNumber)
+{
+    if(m_profileIndex.contains(partNumber))
+        return true;
+
+    SmtProfile profile;
+    if(!m_library->profile(partNumber, &profile, &m_errorString))
+        return false;
+
+    m_program.insertBefore("End_of_FD", profile.text(m_profileNames.count()));
+
+    m_profileIndex.insert(partNumber, m_profileNames.count());
+    m_profileNames.append(partNumber);
+    m_profileHeadMasks.append(profile.headMask);
+    return true;
+}
+
+// Repeats the board's placements for every board of the panel, moved and
+// turned into panel coordinates. Each coordinate is converted once, so the
+// work grows with the number of placements written.
+bool SmtProgram::expandPanel()
+{
+    if(m_panel.isSingleBoard())
+        return true;
+
+    int count = m_placements.count();
+    QVector<QPointF> points(count);
+    QVector<double> rotations(count);
+
+    for(int n = 0; n < count; n++)
+    {
+        const Placement &p = m_placements.at(n);
+        bool ok;
+
+        points[n].setX(p.x.toDouble(&ok));
+        if(!ok)
+        {
+            m_errorString = "Wrong number of Xcontent error.";
+            return false;
+        }
+        points[n].setY(p.y.toDouble(&ok));
+        if(!ok)
+        {
+            m_errorString = "Wrong number of Ycontent error.";
+            return false;
+        }
+        rotations[n] = p.rotation.toDouble(&ok);
+        if(!ok)
+        {
+            m_errorString = "Wrong number of Rot content error.";
+            return false;
+        }
+    }
+
+    QList<Placement> panel;
+    panel.reserve(count * m_panel.boardCount());
+
+    for(int board = 0; board < m_panel.boardCount(); board++)
+    {
+        int boardRotation = m_panel.boardRotation(board);
+        for(int n = 0; n < count; n++)
+        {
+            Placement p = m_placements.at(n);
+            QPointF point = m_panel.map(board, points.at(n));
+            p.x = QString::number(point.x(), 'f', 2);
+            p.y = QString::number(point.y(), 'f', 2);
+            double rotation = fmod(rotations.at(n) + boardRotation, 360);
+            if(rotation < 0)
+                rotation += 360;
+            p.rotation = QString::number(rotation);
+            panel.append(p);
+        }
+    }
+
+    m_placements = panel;
+    return true;
+}
+
+// One bad mark line per board, after the &B.BAD header. The lines follow
+// the layout of the fiducial lines.
+void SmtProgram::writeBadMarks()
+{
+    if(!m_panel.hasBadMark())
+        return;
+
+    QString result;
+    for(int board = 0; board < m_panel.boardCount(); board++)
+    {
+        QPointF point = m_panel.map(board, m_panel.badMark());
+        QString line;
+
+        prepareStrNumber(QString::number(point.x(), 'f', 2), &result);
+        line.append(result);
+        prepareStrNumber(QString::number(point.y(), 'f', 2), &result);
+        line.append(result);
+        prepareStrNumber("0.00", &result);
+        line.append(result);
+        line.append(result);
+        line.append("0A0000FFFF0001000000FFFF00000000 BAD");
+        line.append(QString::number(board + 1));
+        line.append('\n');
+
+        m_program.insertBefore("&B.DSP", line);
+    }
+}
+
+// Order in which the placements are written: the place file order, or with
+// sequence optimization grouped by head and profile along a short path.
+// Coordinates that are not numbers leave the order alone; writing the
+// placements reports them.
+QVector<int> SmtProgram::placementOrder(const QVector<int> &placementProfiles)
+{
+    QVector<int> order;
+    QVector<QPointF> points;
+    bool ok = true;
+
+    for(int n = 0; n < m_placements.size() && ok; n++)
+    {
+        bool okX, okY;
+        double x = m_placements.at(n).x.toDouble(&okX);
+        double y = m_placements.at(n).y.toDouble(&okY);
+        ok = okX && okY;
+        points.append(QPointF(x, y));
+        order.append(n);
+    }
+
+    if(!ok)
+        return order;
+
+    m_travelBefore = SmtSequenceOptimizer::travelLength(points, order);
+
+    if(m_optimizeSequence)
+    {
+        QVector<int> groupKeys;
+        groupKeys.reserve(m_placements.size());
+        for(int n = 0; n < m_placements.size(); n++)
+            groupKeys.append(m_headSchedule.head(n) * m_profileNames.count() + placementProfiles.at(n));
+        order = SmtSequenceOptimizer::optimize(points, groupKeys);
+    }
+
+    m_travelAfter = SmtSequenceOptimizer::travelLength(points, order);
+    return order;
+}
+
+// One line per placement, inserted before the &B.OPT section, with the
+// head chosen by the head scheduler
+bool SmtProgram::writePlacements()
+{
+    QString result;
+
+    QVector<int> placementProfiles;
+    placementProfiles.reserve(m_placements.size());
+    foreach(const Placement &p, m_placements)
+        placementProfiles.append(m_profileIndex.value(p.partNumber));
+    m_headSchedule.schedule(placementProfiles, m_profileHeadMasks);
+
+    foreach(int n, placementOrder(placementProfiles))
+    {
+        const Placement &p = m_placements.at(n);
+        QString line;
+
+        if(prepareStrNumber(p.x, &result) == false)
+        {
+            m_errorString = "Wrong number of Xcontent error.";
+            return false;
+        }
+        line.append(result);
+
+        if(prepareStrNumber(p.y, &result) == false)
+        {
+            m_errorString = "Wrong number of Ycontent error.";
+            return false;
+        }
+        line.append(result);
+
+        prepareStrNumber("0.00", &result);
+        line.append(result);
+
+        // Fractional angles are kept, written with two decimals
+        bool ok;
+        double rotation = p.rotation.toDouble(&ok);
+        if(rotation == 360)
+            rotation = 0;
+        if(!ok || prepareStrNumber(QString::number(rotation, 'f', 2), &result) == false)
+        {
+            m_errorString = "Wrong number of Rot content error.";
+            return false;
+        }
+        line.append(result);
+
+        line.append("0A0000FFFF0001000");
+
+        int j = placementProfiles.at(n);
+        line.append(QString::number(m_headSchedule.head(n)));   // number of head
+
+        if(j < 16)
+            line.append("00FFFF0000000");
+        else
+            line.append("00FFFF000000");
+        line.append(QString::number(j, 16).toUpper());   // number of profile
+
+        line.append(' ');
+
+        QString comment = "                   \n";
+        result = p.designator + ">>>" + p.partNumber;
+        comment.replace(0, result.size(), result);
+        line.append(comment);
+
+        m_program.insertBefore("&B.OPT", line);
+    }
+
+    return true;
+}
+
+
+// Right aligns a number on its decimal point in an 8 character column
+bool SmtProgram::prepareStrNumber(const QString &numberStr, QString *result)
+{
+    int point = numberStr.indexOf('.');
+    QString tempStr;
+    tempStr.append("        ");
+    switch(point)
+    {
+        case 0:
+            return false;
+        case 1:
+            tempStr.replace(4, numberStr.size(), numberStr);
+            break;
+        case 2:
+            tempStr.replace(3, numberStr.size(), numberStr);
+            break;
+        case 3:
+            tempStr.replace(2, numberStr.size(), numberStr);
+            break;
+        case 4:
+            tempStr.replace(1, numberStr.size(), numberStr);
+            break;
+        case 5:
+            tempStr.replace(0, numberStr.size(), numberStr);
+            break;
+    }
+    tempStr.resize(8);
+    tempStr.append(' ');
+    *result = tempStr;
+    return true;
+}
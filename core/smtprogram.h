@@ -0,0 +1,133 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SMTPROGRAM_H
+#define SMTPROGRAM_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QVector>
+
+#include "smttemplate.h"
+#include "smtheadscheduler.h"
+#include "smtpanel.h"
+
+class SmtProfileLibrary;
+
+// Yamaha SMT program built from a pick and place file. The placements
+// (A = CenterX, B = CenterY, C = Rotation, D = Designator) get their part
+// number from the BOM designator lists, or from column E of the place file
+// when no BOM is given. BOM designator cells are comma separated lists that
+// may hold ranges ("R1-R12" or "R1-12"). Profiles and the board_temp.txt
+// template come from a SmtProfileLibrary. With a panel set, the place file
+// describes one board and is repeated for every board of the panel.
+class SmtProgram
+{
+    Q_DECLARE_TR_FUNCTIONS(SmtProgram)
+
+public:
+    struct Placement
+    {
+        QString x;
+        QString y;
+        QString rotation;
+        QString designator;
+        QString partNumber;
+    };
+
+    explicit SmtProgram(SmtProfileLibrary *library);
+
+    void setOptimizeSequence(bool optimize)
+    {
+        m_optimizeSequence = optimize;
+    }
+    void setPanel(const SmtPanel &panel)
+    {
+        m_panel = panel;
+    }
+
+    bool generate(const QString &pcbName, const QString &placeFilePath,
+                  const QString &bomFilePath = QString());
+    bool save(const QString &filePath) const;
+
+    QString text() const
+    {
+        return m_program.toString();
+    }
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+    QList<Placement> placements() const
+    {
+        return m_placements;
+    }
+    QStringList profileNames() const
+    {
+        return m_profileNames;
+    }
+    const SmtHeadScheduler &headSchedule() const
+    {
+        return m_headSchedule;
+    }
+    // Gantry travel in place file order and in the written order
+    double travelBefore() const
+    {
+        return m_travelBefore;
+    }
+    double travelAfter() const
+    {
+        return m_travelAfter;
+    }
+
+    static QStringList expandDesignators(const QString &cell);
+
+    static bool prepareStrNumber(const QString &numberStr, QString *result);
+
+private:
+    SmtProfileLibrary *m_library;
+    QString m_errorString;
+
+    bool m_withBom;
+    bool m_optimizeSequence;
+    SmtPanel m_panel;
+    double m_travelBefore;
+    double m_travelAfter;
+    QStringList m_bomPartNumbers;
+    QHash<QString, int> m_designatorRow;    // designator -> index in m_bomPartNumbers
+    QList<Placement> m_placements;
+    QStringList m_profileNames;
+    QHash<QString, int> m_profileIndex;
+    QVector<quint8> m_profileHeadMasks;     // heads allowed by each profile
+    SmtHeadScheduler m_headSchedule;
+    SmtTemplate m_program;
+
+    bool readBom(const QString &filePath);
+    bool readPlacements(const QString &filePath, bool withPartNumbers);
+    bool assignPartNumbers();
+    bool addProfile(const QString &partNumber);
+    bool expandPanel();
+    void writeBadMarks();
+    QVector<int> placementOrder(const QVector<int> &placementProfiles);
+    bool writePlacements();
+};
+
+#endif // SMTPROGRAM_H
@@ -0,0 +1,180 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "smtsequenceoptimizer.h"
+
+#include <QtConcurrentMap>
+#include <QHash>
+#include <QList>
+#include <qmath.h>
+
+// More 2-opt passes rarely pay off; a pass is quadratic in the group size
+#define SEQUENCE_MAX_PASSES 50
+
+static inline double distance(const QPointF &p1, const QPointF &p2)
+{
+    double dx = p1.x() - p2.x();
+    double dy = p1.y() - p2.y();
+    return qSqrt(dx * dx + dy * dy);
+}
+
+bool SmtSequenceOptimizer::groupLessThan(const Group &g1, const Group &g2)
+{
+    return g1.key < g2.key;
+}
+
+// Returns the new placement order as indexes into 'points'
+QVector<int> SmtSequenceOptimizer::optimize(const QVector<QPointF> &points, const QVector<int> &groupKeys)
+{
+    QHash<int, int> groupIndex;
+    QList<Group> groups;
+
+    for(int n = 0; n < points.size(); n++)
+    {
+        int key = groupKeys.at(n);
+        int index = groupIndex.value(key, -1);
+        if(index < 0)
+        {
+            index = groups.count();
+            groupIndex.insert(key, index);
+
+            Group group;
+            group.key = key;
+            groups.append(group);
+        }
+
+        groups[index].members.append(n);
+        groups[index].points.append(points.at(n));
+    }
+
+    qSort(groups.begin(), groups.end(), groupLessThan);
+
+    QPointF current(0, 0);
+    for(int i = 0; i < groups.count(); i++)
+    {
+        Group &group = groups[i];
+        group.start = current;
+        group.fixedEnd = (i + 1 < groups.count());
+        nearestNeighbour(group);
+        current = group.points.last();
+    }
+
+    QtConcurrent::blockingMap(groups, twoOpt);
+
+    QVector<int> order;
+    order.reserve(points.size());
+    foreach(const Group &group, groups)
+        order += group.members;
+    return order;
+}
+
+double SmtSequenceOptimizer::travelLength(const QVector<QPointF> &points, const QVector<int> &order)
+{
+    double length = 0;
+    for(int n = 1; n < order.size(); n++)
+        length += distance(points.at(order.at(n - 1)), points.at(order.at(n)));
+    return length;
+}
+
+void SmtSequenceOptimizer::nearestNeighbour(Group &group)
+{
+    int count = group.members.size();
+
+    QVector<int> members;
+    QVector<QPointF> points;
+    QVector<bool> visited(count, false);
+    members.reserve(count);
+    points.reserve(count);
+
+    QPointF current = group.start;
+    for(int step = 0; step < count; step++)
+    {
+        int best = -1;
+        double bestDistance = 0;
+        for(int n = 0; n < count; n++)
+        {
+            if(visited.at(n))
+                continue;
+            double d = distance(current, group.points.at(n));
+            if(best < 0 || d < bestDistance)
+            {
+                best = n;
+                bestDistance = d;
+            }
+        }
+
+        visited[best] = true;
+        current = group.points.at(best);
+        members.append(group.members.at(best));
+        points.append(current);
+    }
+
+    group.members = members;
+    group.points = points;
+}
+
+// Open path 2-opt over the group entered from its start: reversing points
+// i+1..j replaces the edges (i, i+1) and (j, j+1) by (i, j) and
+// (i+1, j+1), point 0 being the start, which stays in place. Unless the
+// group is the last one, its last point stays too, so that the next group
+// still starts where it was walked from; otherwise it has no following edge.
+void SmtSequenceOptimizer::twoOpt(Group &group)
+{
+    int count = group.points.size() + 1;
+    int end = group.fixedEnd ? count - 1 : count;
+    if(end < 3)
+        return;
+
+    QVector<QPointF> p = group.points;
+    QVector<int> members = group.members;
+    p.prepend(group.start);
+    members.prepend(-1);
+
+    bool improved = true;
+
+    for(int pass = 0; improved && pass < SEQUENCE_MAX_PASSES; pass++)
+    {
+        improved = false;
+        for(int i = 0; i < end - 2; i++)
+        {
+            for(int j = i + 2; j < end; j++)
+            {
+                double before = distance(p.at(i), p.at(i + 1));
+                double after = distance(p.at(i), p.at(j));
+                if(j + 1 < count)
+                {
+                    before += distance(p.at(j), p.at(j + 1));
+                    after += distance(p.at(i + 1), p.at(j + 1));
+                }
+
+                if(after < before - 1e-9)
+                {
+                    for(int a = i + 1, b = j; a < b; a++, b--)
+                    {
+                        qSwap(p[a], p[b]);
+                        qSwap(members[a], members[b]);
+                    }
+                    improved = true;
+                }
+            }
+        }
+    }
+
+    group.points = p.mid(1);
+    group.members = members.mid(1);
+}
@@ -0,0 +1,52 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SMTSEQUENCEOPTIMIZER_H
+#define SMTSEQUENCEOPTIMIZER_H
+
+#include <QVector>
+#include <QPointF>
+
+// Placement order with a short gantry path. Placements are grouped by a
+// key (head and profile) and the groups follow each other in key order.
+// Each group is walked nearest neighbour first, starting where the
+// previous group ended (the first one at the board origin), then improved
+// with 2-opt. The 2-opt passes, the costly part, keep the ends the groups
+// are chained by and run on the groups in parallel.
+class SmtSequenceOptimizer
+{
+public:
+    static QVector<int> optimize(const QVector<QPointF> &points, const QVector<int> &groupKeys);
+    static double travelLength(const QVector<QPointF> &points, const QVector<int> &order);
+
+private:
+    struct Group
+    {
+        int key;
+        QVector<int> members;       // indexes in the points vector, in path order
+        QVector<QPointF> points;    // positions of the members
+        QPointF start;              // where the gantry comes from
+        bool fixedEnd;              // the next group starts at the last point
+    };
+
+    static void nearestNeighbour(Group &group);
+    static void twoOpt(Group &group);
+    static bool groupLessThan(const Group &g1, const Group &g2);
+};
+
+#endif // SMTSEQUENCEOPTIMIZER_H
@@ -0,0 +1,116 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "smttemplate.h"
+
+#include <QFile>
+#include <QTextStream>
+
+SmtTemplate::SmtTemplate()
+{
+}
+
+void SmtTemplate::clear()
+{
+    m_sections.clear();
+    m_index.clear();
+}
+
+bool SmtTemplate::load(const QString &filePath)
+{
+    clear();
+
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QString text = file.readAll();
+    file.close();
+
+    Section section;
+    int start = 0;
+    while(start < text.size())
+    {
+        int end = text.indexOf('\n', start);
+        end = (end < 0) ? text.size() : end + 1;
+
+        QString line = text.mid(start, end - start);
+        if(line.startsWith('&') || line.startsWith("End_of_"))
+        {
+            if(!section.name.isEmpty() || !section.text.isEmpty())
+                m_sections.append(section);
+
+            int length = 0;
+            while(length < line.size() && line.at(length) != ' ' && line.at(length) != '='
+                    && line.at(length) != '\n')
+                length++;
+
+            section = Section();
+            section.name = line.left(length);
+            if(!m_index.contains(section.name))
+                m_index.insert(section.name, m_sections.count());
+        }
+
+        section.text += line;
+        start = end;
+    }
+    m_sections.append(section);
+
+    return true;
+}
+
+// Adds text in front of a section, after whatever was added there before
+void SmtTemplate::insertBefore(const QString &name, const QString &text)
+{
+    int index = m_index.value(name, -1);
+    if(index >= 0)
+        m_sections[index].inserted += text;
+}
+
+// Overwrites the characters following 'field' (e.g. "PCBNAME=") with
+// 'value', keeping the line length
+bool SmtTemplate::replaceField(const QString &field, const QString &value)
+{
+    for(int i = 0; i < m_sections.count(); i++)
+    {
+        QString &text = m_sections[i].text;
+        int point = text.indexOf(field);
+        if(point >= 0)
+        {
+            text.replace(point + field.size(), value.size(), value);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SmtTemplate::write(QTextStream &stream) const
+{
+    foreach(const Section &section, m_sections)
+        stream << section.inserted << section.text;
+}
+
+QString SmtTemplate::toString() const
+{
+    QString result;
+    QTextStream stream(&result);
+    write(stream);
+    stream.flush();
+    return result;
+}
@@ -0,0 +1,65 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SMTTEMPLATE_H
+#define SMTTEMPLATE_H
+
+#include <QString>
+#include <QList>
+#include <QHash>
+
+class QTextStream;
+
+// Yamaha program template (board_temp.txt) split into its sections. A
+// section starts at every line beginning with '&' or "End_of_" and is
+// named after the first word of that line ("&B.MNT", "End_of_FD", ...);
+// the lines before the first one form an unnamed section. Text added in
+// front of a section is collected in a buffer of its own and only joined
+// with the template when the program is written out.
+class SmtTemplate
+{
+public:
+    SmtTemplate();
+
+    bool load(const QString &filePath);
+    void clear();
+
+    bool hasSection(const QString &name) const
+    {
+        return m_index.contains(name);
+    }
+
+    void insertBefore(const QString &name, const QString &text);
+    bool replaceField(const QString &field, const QString &value);
+
+    void write(QTextStream &stream) const;
+    QString toString() const;
+
+private:
+    struct Section
+    {
+        QString name;
+        QString text;           // template lines, header included
+        QString inserted;       // written before 'text'
+    };
+
+    QList<Section> m_sections;
+    QHash<QString, int> m_index;
+};
+
+#endif // SMTTEMPLATE_H
@@ -0,0 +1,502 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "snapshot.h"
+#include "co.h"
+#include "component.h"
+#include "applicationnote.h"
+#include "datasheet.h"
+#include "manufacturer.h"
+#include "package.h"
+#include "container.h"
+#include "label.h"
+#include "stock.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QVector>
+#include <QDebug>
+
+namespace
+{
+
+const quint32 SnapshotMagic = 0x434f5331;   // "COS1", also catches a byte order change
+const quint32 SnapshotVersion = 1;
+const quint32 NoString = 0xffffffff;
+
+enum Section
+{
+    StringOffsets = 0,      // quint32[count + 1], in QChars
+    StringData,             // QChar[count]
+    Manufacturers,
+    Packages,
+    Containers,
+    TopLabels,
+    LeafLabels,             // leafs of all top labels, in order
+    Components,
+    Datasheets,
+    Stocks,
+    ApplicationNotes,
+    SectionCount
+};
+
+struct Header
+{
+    quint32 magic;
+    quint32 version;
+    qint64 xmlSize;
+    qint64 xmlModified;
+    quint32 generation;
+    quint32 reserved;
+    quint32 count[SectionCount];
+    quint32 offset[SectionCount];
+};
+
+struct NameRecord
+{
+    quint32 name;
+};
+
+struct LabelRecord
+{
+    quint32 name;
+    quint32 firstLeaf;
+    quint32 leafCount;
+};
+
+struct ComponentRecord
+{
+    quint32 name;
+    quint32 description;
+    quint32 notes;
+    quint32 link;
+    qint32 container;
+    qint32 primaryLabel;    // index in TopLabels
+    qint32 secondaryLabel;  // index in LeafLabels
+    qint32 defaultDatasheet;
+    quint32 ignoreStock;
+    quint32 firstDatasheet;
+    quint32 datasheetCount;
+    quint32 firstStock;
+    quint32 stockCount;
+};
+
+struct DatasheetRecord
+{
+    quint32 path;
+    qint32 type;
+    qint32 manufacturer;
+};
+
+struct StockRecord
+{
+    qint32 package;
+    qint32 value;
+    qint32 low;
+};
+
+struct ApplicationNoteRecord
+{
+    quint32 description;
+    quint32 name;
+    quint32 pdfPath;
+    quint32 attachedFile;
+};
+
+const quint32 RecordSize[SectionCount] =
+{
+    sizeof(quint32), sizeof(QChar), sizeof(NameRecord), sizeof(NameRecord), sizeof(NameRecord),
+    sizeof(LabelRecord), sizeof(NameRecord), sizeof(ComponentRecord), sizeof(DatasheetRecord),
+    sizeof(StockRecord), sizeof(ApplicationNoteRecord)
+};
+
+class StringTable
+{
+public:
+    StringTable()
+    {
+        m_offsets.append(0);
+    }
+
+    quint32 add(const QString &str)
+    {
+        QHash<QString, quint32>::const_iterator i = m_index.constFind(str);
+        if(i != m_index.constEnd())
+            return i.value();
+
+        quint32 id = m_offsets.count() - 1;
+        m_data.append(str);
+        m_offsets.append(m_data.size());
+        m_index.insert(str, id);
+        return id;
+    }
+
+    const QVector<quint32> &offsets() const
+    {
+        return m_offsets;
+    }
+    const QString &data() const
+    {
+        return m_data;
+    }
+
+private:
+    QHash<QString, quint32> m_index;
+    QVector<quint32> m_offsets;
+    QString m_data;
+};
+
+template <class T>
+void appendRecord(QByteArray *section, const T &record)
+{
+    section->append(reinterpret_cast<const char *>(&record), sizeof(T));
+}
+
+template <class T>
+QHash<T *, int> indexOf(const QList<T *> &list)
+{
+    QHash<T *, int> hash;
+    for(int i = 0; i < list.count(); i++)
+        hash.insert(list.at(i), i);
+    return hash;
+}
+
+class StringReader
+{
+public:
+    StringReader(const quint32 *offsets, quint32 count, const QChar *data, quint32 size) :
+        m_offsets(offsets), m_count(count), m_data(data), m_size(size)
+    {
+    }
+
+    QString at(quint32 id) const
+    {
+        if(id >= m_count)
+            return QString();
+
+        quint32 begin = m_offsets[id];
+        quint32 end = m_offsets[id + 1];
+        if(begin > end || end > m_size)
+            return QString();
+
+        return QString(m_data + begin, end - begin);
+    }
+
+private:
+    const quint32 *m_offsets;
+    quint32 m_count;
+    const QChar *m_data;
+    quint32 m_size;
+};
+
+}
+
+bool Snapshot::write(CO *co, const QString &filePath, const QString &xmlPath, quint32 generation,
+                     const QMap<Component *, QString> &links)
+{
+    QFileInfo xmlInfo(xmlPath);
+    if(!xmlInfo.exists())
+        return false;
+
+    StringTable strings;
+    QByteArray sections[SectionCount];
+    quint32 count[SectionCount];
+    for(int i = 0; i < SectionCount; i++)
+        count[i] = 0;
+
+    QList<Manufacturer *> manufacturers = co->manufacturers();
+    QList<Package *> packages = co->getPackages();
+    QList<Container *> containers = co->containers();
+    QList<Label *> topLabels = co->topLabels();
+
+    QHash<Manufacturer *, int> manufacturerIndex = indexOf(manufacturers);
+    QHash<Package *, int> packageIndex = indexOf(packages);
+    QHash<Container *, int> containerIndex = indexOf(containers);
+    QHash<Label *, int> topLabelIndex = indexOf(topLabels);
+    QHash<Label *, int> leafLabelIndex;
+
+    foreach(Manufacturer *m, manufacturers)
+    {
+        NameRecord r = { strings.add(m->name()) };
+        appendRecord(&sections[Manufacturers], r);
+    }
+    foreach(Package *p, packages)
+    {
+        NameRecord r = { strings.add(p->name()) };
+        appendRecord(&sections[Packages], r);
+    }
+    foreach(Container *c, containers)
+    {
+        NameRecord r = { strings.add(c->name()) };
+        appendRecord(&sections[Containers], r);
+    }
+    foreach(Label *top, topLabels)
+    {
+        LabelRecord r = { strings.add(top->name()), count[LeafLabels], (quint32) top->leafs().count() };
+        appendRecord(&sections[TopLabels], r);
+
+        foreach(Label *leaf, top->leafs())
+        {
+            NameRecord l = { strings.add(leaf->name()) };
+            appendRecord(&sections[LeafLabels], l);
+            leafLabelIndex.insert(leaf, count[LeafLabels]++);
+        }
+    }
+
+    foreach(Component *c, co->components())
+    {
+        QString link = c->isLinked() ? c->linkedTo()->name() : links.value(c);
+
+        ComponentRecord r;
+        r.name = strings.add(c->name());
+        r.description = strings.add(c->description());
+        r.notes = strings.add(c->notes());
+        r.link = link.isEmpty() ? NoString : strings.add(link);
+        r.container = containerIndex.value(c->container(), -1);
+        r.primaryLabel = topLabelIndex.value(c->primaryLabel(), -1);
+        r.secondaryLabel = leafLabelIndex.value(c->secondaryLabel(), -1);
+        r.defaultDatasheet = c->defaultDatasheetIndex();
+        r.ignoreStock = c->ignoreStock() ? 1 : 0;
+        r.firstDatasheet = count[Datasheets];
+        r.datasheetCount = c->datasheets().count();
+        r.firstStock = count[Stocks];
+        r.stockCount = c->stocks().count();
+        appendRecord(&sections[Components], r);
+
+        foreach(Datasheet *d, c->datasheets())
+        {
+            DatasheetRecord dr = { strings.add(d->path()), d->type(), manufacturerIndex.value(d->manufacturer(), -1) };
+            appendRecord(&sections[Datasheets], dr);
+            count[Datasheets]++;
+        }
+
+        foreach(const Stock &s, c->stocks())
+        {
+            StockRecord sr = { packageIndex.value(s.package(), -1), s.stock(), s.lowValue() };
+            appendRecord(&sections[Stocks], sr);
+            count[Stocks]++;
+        }
+    }
+
+    foreach(ApplicationNote *a, co->applicationNotes())
+    {
+        ApplicationNoteRecord r = { strings.add(a->description()), strings.add(a->name()),
+                                    strings.add(a->pdfPath()), strings.add(a->attachedFilePath())
+                                  };
+        appendRecord(&sections[ApplicationNotes], r);
+    }
+
+    sections[StringOffsets] = QByteArray(reinterpret_cast<const char *>(strings.offsets().constData()),
+                                         strings.offsets().count() * sizeof(quint32));
+    sections[StringData] = QByteArray(reinterpret_cast<const char *>(strings.data().constData()),
+                                      strings.data().size() * sizeof(QChar));
+
+    Header header;
+    header.magic = SnapshotMagic;
+    header.version = SnapshotVersion;
+    header.xmlSize = xmlInfo.size();
+    header.xmlModified = xmlInfo.lastModified().toMSecsSinceEpoch();
+    header.generation = generation;
+    header.reserved = 0;
+
+    quint32 offset = sizeof(Header);
+    for(int i = 0; i < SectionCount; i++)
+    {
+        while(sections[i].size() % 4)
+            sections[i].append('\0');
+
+        header.count[i] = sections[i].size() / RecordSize[i];
+        header.offset[i] = offset;
+        offset += sections[i].size();
+    }
+    header.count[StringOffsets] = strings.offsets().count() - 1;
+    header.count[StringData] = strings.data().size();
+
+    // Written aside and renamed, so a crash never leaves a half snapshot
+    QString tempPath = filePath + ".tmp";
+    QFile file(tempPath);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qDebug() << "Unable to write snapshot:" << file.errorString();
+        return false;
+    }
+
+    bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(Header)) == sizeof(Header);
+    for(int i = 0; i < SectionCount && ok; i++)
+        ok = file.write(sections[i]) == sections[i].size();
+    file.close();
+
+    if(!ok)
+    {
+        QFile::remove(tempPath);
+        return false;
+    }
+
+    QFile::remove(filePath);
+    return QFile::rename(tempPath, filePath);
+}
+
+bool Snapshot::read(CO *co, const QString &filePath, const QString &xmlPath, quint32 *generation,
+                    QMap<Component *, QString> *links)
+{
+    QFile file(filePath);
+    QFileInfo xmlInfo(xmlPath);
+
+    if(!xmlInfo.exists() || !file.open(QIODevice::ReadOnly) || file.size() < (qint64)sizeof(Header))
+        return false;
+
+    uchar *base = file.map(0, file.size());
+    if(base == 0)
+        return false;
+
+    const Header *header = reinterpret_cast<const Header *>(base);
+
+    if(header->magic != SnapshotMagic || header->version != SnapshotVersion ||
+            header->xmlSize != xmlInfo.size() ||
+            header->xmlModified != xmlInfo.lastModified().toMSecsSinceEpoch())
+    {
+        qDebug() << "snapshot is stale";
+        return false;
+    }
+
+    // Everything is checked before the first object is created, so a bad
+    // file falls back to the XML without leaving anything half loaded
+    for(int i = 0; i < SectionCount; i++)
+    {
+        quint64 count = header->count[i] + (i == StringOffsets ? 1 : 0);
+        if(header->offset[i] % 4 || header->offset[i] + count * RecordSize[i] > (quint64)file.size())
+            return false;
+    }
+
+    const quint32 *offsets = reinterpret_cast<const quint32 *>(base + header->offset[StringOffsets]);
+    const QChar *data = reinterpret_cast<const QChar *>(base + header->offset[StringData]);
+    StringReader strings(offsets, header->count[StringOffsets], data, header->count[StringData]);
+
+    const NameRecord *manufacturerRecords = reinterpret_cast<const NameRecord *>(base + header->offset[Manufacturers]);
+    const NameRecord *packageRecords = reinterpret_cast<const NameRecord *>(base + header->offset[Packages]);
+    const NameRecord *containerRecords = reinterpret_cast<const NameRecord *>(base + header->offset[Containers]);
+    const LabelRecord *topLabelRecords = reinterpret_cast<const LabelRecord *>(base + header->offset[TopLabels]);
+    const NameRecord *leafLabelRecords = reinterpret_cast<const NameRecord *>(base + header->offset[LeafLabels]);
+    const ComponentRecord *componentRecords = reinterpret_cast<const ComponentRecord *>(base + header->offset[Components]);
+    const DatasheetRecord *datasheetRecords = reinterpret_cast<const DatasheetRecord *>(base + header->offset[Datasheets]);
+    const StockRecord *stockRecords = reinterpret_cast<const StockRecord *>(base + header->offset[Stocks]);
+    const ApplicationNoteRecord *appnoteRecords = reinterpret_cast<const ApplicationNoteRecord *>(base + header->offset[ApplicationNotes]);
+
+    for(quint32 i = 0; i < header->count[TopLabels]; i++)
+        if((quint64)topLabelRecords[i].firstLeaf + topLabelRecords[i].leafCount > header->count[LeafLabels])
+            return false;
+
+    for(quint32 i = 0; i < header->count[Components]; i++)
+    {
+        const ComponentRecord &r = componentRecords[i];
+        if((quint64)r.firstDatasheet + r.datasheetCount > header->count[Datasheets] ||
+                (quint64)r.firstStock + r.stockCount > header->count[Stocks])
+            return false;
+    }
+
+    QVector<Manufacturer *> manufacturers(header->count[Manufacturers]);
+    QVector<Package *> packages(header->count[Packages]);
+    QVector<Container *> containers(header->count[Containers]);
+    QVector<Label *> topLabels(header->count[TopLabels]);
+    QVector<Label *> leafLabels(header->count[LeafLabels]);
+
+    for(int i = 0; i < manufacturers.count(); i++)
+    {
+        manufacturers[i] = new Manufacturer(strings.at(manufacturerRecords[i].name));
+        co->addManufacturer(manufacturers[i]);
+    }
+    for(int i = 0; i < packages.count(); i++)
+    {
+        packages[i] = new Package(strings.at(packageRecords[i].name));
+        co->addPackage(packages[i]);
+    }
+    for(int i = 0; i < containers.count(); i++)
+    {
+        containers[i] = new Container(strings.at(containerRecords[i].name));
+        co->addContainer(containers[i]);
+    }
+    for(int i = 0; i < topLabels.count(); i++)
+    {
+        const LabelRecord &r = topLabelRecords[i];
+        Label *top = new Label(strings.at(r.name));
+
+        for(quint32 j = r.firstLeaf; j < r.firstLeaf + r.leafCount; j++)
+        {
+            Label *leaf = new Label(strings.at(leafLabelRecords[j].name));
+            leaf->setTop(top);
+            top->addLeaf(leaf);
+            leafLabels[j] = leaf;
+        }
+
+        topLabels[i] = top;
+        co->addTopLabel(top);
+    }
+
+    for(quint32 i = 0; i < header->count[Components]; i++)
+    {
+        const ComponentRecord &r = componentRecords[i];
+        Component *c = new Component(strings.at(r.name));
+
+        c->setDescription(strings.at(r.description));
+
+        for(quint32 j = r.firstDatasheet; j < r.firstDatasheet + r.datasheetCount; j++)
+        {
+            const DatasheetRecord &dr = datasheetRecords[j];
+            Datasheet *d = new Datasheet(strings.at(dr.path));
+            d->setType((Datasheet::Type) dr.type);
+            d->setManufacturer(manufacturers.value(dr.manufacturer, 0));
+            c->addDatasheet(d);
+        }
+        c->setDefaultDatasheetIndex(r.defaultDatasheet);
+
+        c->setIgnoreStock(r.ignoreStock != 0);
+        for(quint32 j = r.firstStock; j < r.firstStock + r.stockCount; j++)
+        {
+            const StockRecord &sr = stockRecords[j];
+            Stock s(packages.value(sr.package, 0));
+            s.setStock(sr.value);
+            s.setLowValue(sr.low);
+            c->addStock(s);
+        }
+
+        c->setContainer(containers.value(r.container, 0));
+        c->setLabels(topLabels.value(r.primaryLabel, 0), leafLabels.value(r.secondaryLabel, 0));
+        c->setNotes(strings.at(r.notes));
+
+        if(r.link != NoString)
+            links->insert(c, strings.at(r.link));
+
+        co->addComponent(c);
+    }
+
+    for(quint32 i = 0; i < header->count[ApplicationNotes]; i++)
+    {
+        const ApplicationNoteRecord &r = appnoteRecords[i];
+        ApplicationNote *a = new ApplicationNote(strings.at(r.description));
+        a->setName(strings.at(r.name));
+        a->setPdfPath(strings.at(r.pdfPath));
+        a->setAttachedFilePath(strings.at(r.attachedFile));
+        co->addApplicationNote(a);
+    }
+
+    *generation = header->generation;
+
+    return true;
+}
@@ -0,0 +1,42 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <QString>
+#include <QMap>
+
+class CO;
+class Component;
+
+// Binary copy of data.xml (data.xml.snap) used to start up without parsing
+// the XML. It holds a string table and fixed-size records that refer to
+// each other by index, and is read straight from a memory mapping. The
+// snapshot remembers the size and modification time of the data.xml it was
+// made from and is ignored as soon as they no longer match.
+class Snapshot
+{
+public:
+    static bool write(CO *co, const QString &filePath, const QString &xmlPath, quint32 generation,
+                      const QMap<Component *, QString> &links = QMap<Component *, QString>());
+    static bool read(CO *co, const QString &filePath, const QString &xmlPath, quint32 *generation,
+                     QMap<Component *, QString> *links);
+};
+
+#endif // SNAPSHOT_H
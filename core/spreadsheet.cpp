@@ -0,0 +1,351 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "spreadsheet.h"
+#include "zipreader.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QXmlStreamReader>
+
+#include <QDebug>
+
+static const QString RelationshipsNamespace =
+    "http://schemas.openxmlformats.org/officeDocument/2006/relationships";
+
+// "AB12" -> 28
+static int columnFromReference(const QString &reference)
+{
+    int column = 0;
+
+    for(int i = 0; i < reference.size(); i++)
+    {
+        QChar c = reference.at(i).toUpper();
+        if(c < 'A' || c > 'Z')
+            break;
+        column = column * 26 + (c.unicode() - 'A' + 1);
+    }
+
+    return column;
+}
+
+SpreadSheet::SpreadSheet()
+{
+}
+
+bool SpreadSheet::load(const QString &filePath)
+{
+    m_rows.clear();
+    m_errorString.clear();
+
+    QString suffix = QFileInfo(filePath).suffix().toLower();
+
+    if(suffix == "csv" || suffix == "txt")
+        return loadCsv(filePath);
+    else if(suffix == "xlsx" || suffix == "xlsm")
+        return loadXlsx(filePath);
+
+    m_errorString = tr("Unsupported file format (only .xlsx and .csv): ") + filePath;
+    return false;
+}
+
+QString SpreadSheet::cell(int row, int column) const
+{
+    if(row < 1 || row > m_rows.count())
+        return QString();
+
+    const QStringList &cells = m_rows.at(row - 1);
+    if(column < 1 || column > cells.count())
+        return QString();
+
+    return cells.at(column - 1);
+}
+
+int SpreadSheet::intCell(int row, int column) const
+{
+    return qRound(cell(row, column).toDouble());
+}
+
+QStringList SpreadSheet::row(int row) const
+{
+    if(row < 1 || row > m_rows.count())
+        return QStringList();
+
+    return m_rows.at(row - 1);
+}
+
+void SpreadSheet::setCell(int row, int column, const QString &value)
+{
+    if(row < 1 || column < 1)
+        return;
+
+    while(m_rows.count() < row)
+        m_rows.append(QStringList());
+
+    QStringList &cells = m_rows[row - 1];
+    while(cells.count() < column)
+        cells.append(QString());
+
+    cells[column - 1] = value;
+}
+
+bool SpreadSheet::loadXlsx(const QString &filePath)
+{
+    ZipReader zip(filePath);
+
+    if(!zip.isOpen())
+    {
+        m_errorString = tr("Unable to open ") + filePath + ": " + zip.errorString();
+        return false;
+    }
+
+    QStringList sharedStrings;
+    if(zip.contains("xl/sharedStrings.xml"))
+    {
+        if(!readSharedStrings(zip.fileData("xl/sharedStrings.xml"), &sharedStrings))
+            return false;
+    }
+
+    QString sheetPath = firstSheetPath(zip.fileData("xl/workbook.xml"),
+                                       zip.fileData("xl/_rels/workbook.xml.rels"));
+    if(sheetPath.isEmpty() || !zip.contains(sheetPath))
+        sheetPath = "xl/worksheets/sheet1.xml";
+
+    if(!zip.contains(sheetPath))
+    {
+        m_errorString = tr("No worksheet found in ") + filePath;
+        return false;
+    }
+
+    return readSheet(zip.fileData(sheetPath), sharedStrings);
+}
+
+bool SpreadSheet::readSharedStrings(const QByteArray &data, QStringList *strings)
+{
+    QXmlStreamReader xml(data);
+    QString current;
+
+    while(!xml.atEnd())
+    {
+        xml.readNext();
+
+        if(xml.isStartElement())
+        {
+            if(xml.name() == QLatin1String("si"))
+                current.clear();
+            else if(xml.name() == QLatin1String("t"))
+                current.append(xml.readElementText());
+            else if(xml.name() == QLatin1String("rPh")) // phonetic hints
+                xml.skipCurrentElement();
+        }
+        else if(xml.isEndElement() && xml.name() == QLatin1String("si"))
+        {
+            strings->append(current);
+        }
+    }
+
+    if(xml.hasError())
+    {
+        m_errorString = tr("Shared strings error: ") + xml.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+QString SpreadSheet::firstSheetPath(const QByteArray &workbook, const QByteArray &relations)
+{
+    QString id;
+
+    QXmlStreamReader xml(workbook);
+    while(!xml.atEnd() && id.isEmpty())
+    {
+        xml.readNext();
+        if(xml.isStartElement() && xml.name() == QLatin1String("sheet"))
+            id = xml.attributes().value(RelationshipsNamespace, "id").toString();
+    }
+
+    if(id.isEmpty())
+        return QString();
+
+    QXmlStreamReader rels(relations);
+    while(!rels.atEnd())
+    {
+        rels.readNext();
+        if(rels.isStartElement() && rels.name() == QLatin1String("Relationship") &&
+                rels.attributes().value("Id") == id)
+        {
+            QString target = rels.attributes().value("Target").toString();
+            if(target.startsWith('/'))
+                return target.mid(1);
+            return "xl/" + target;
+        }
+    }
+
+    return QString();
+}
+
+bool SpreadSheet::readSheet(const QByteArray &data, const QStringList &sharedStrings)
+{
+    QXmlStreamReader xml(data);
+    int row = 0;
+    int column = 0;
+
+    while(!xml.atEnd())
+    {
+        xml.readNext();
+
+        if(!xml.isStartElement())
+            continue;
+
+        if(xml.name() == QLatin1String("row"))
+        {
+            QStringRef r = xml.attributes().value("r");
+            row = r.isEmpty() ? row + 1 : r.toString().toInt();
+            column = 0;
+        }
+        else if(xml.name() == QLatin1String("c"))
+        {
+            QString reference = xml.attributes().value("r").toString();
+            QString type = xml.attributes().value("t").toString();
+            column = reference.isEmpty() ? column + 1 : columnFromReference(reference);
+
+            QString value;
+            while(xml.readNextStartElement())
+            {
+                if(xml.name() == QLatin1String("v"))
+                    value = xml.readElementText();
+                else if(xml.name() == QLatin1String("is"))
+                    value = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+                else
+                    xml.skipCurrentElement();
+            }
+
+            if(value.isEmpty())
+                continue;
+
+            if(type == "s")
+            {
+                int index = value.toInt();
+                value = (index >= 0 && index < sharedStrings.count()) ? sharedStrings.at(index) : QString();
+            }
+            else if(type == "b")
+            {
+                value = (value == "1") ? "true" : "false";
+            }
+            else if(type.isEmpty() || type == "n")
+            {
+                // Same text Excel's Value() gives through QVariant, e.g.
+                // "0.10000000000000001" is read back as "0.1"
+                if(value.contains('.') || value.contains('E') || value.contains('e'))
+                {
+                    bool ok;
+                    double number = value.toDouble(&ok);
+                    if(ok)
+                        value = QString::number(number, 'g', 15);
+                }
+            }
+
+            setCell(row, column, value);
+        }
+    }
+
+    if(xml.hasError())
+    {
+        m_errorString = tr("Worksheet error: ") + xml.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool SpreadSheet::loadCsv(const QString &filePath)
+{
+    QFile file(filePath);
+
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        m_errorString = tr("Unable to open ") + filePath + ": " + file.errorString();
+        return false;
+    }
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    QString text = stream.readAll();
+    file.close();
+
+    // Excel writes ';' separated files on locales using ',' as decimal point
+    QString firstLine = text.left(text.indexOf('\n'));
+    QChar separator = ',';
+    if(firstLine.count(';') > firstLine.count(separator))
+        separator = ';';
+    if(firstLine.count('\t') > firstLine.count(separator))
+        separator = '\t';
+
+    int row = 1;
+    int column = 1;
+    QString field;
+    bool quoted = false;
+
+    for(int i = 0; i < text.size(); i++)
+    {
+        QChar c = text.at(i);
+
+        if(quoted)
+        {
+            if(c == '"')
+            {
+                if(i + 1 < text.size() && text.at(i + 1) == '"')
+                {
+                    field.append('"');
+                    i++;
+                }
+                else
+                    quoted = false;
+            }
+            else
+                field.append(c);
+        }
+        else if(c == '"')
+        {
+            quoted = true;
+        }
+        else if(c == separator)
+        {
+            setCell(row, column++, field);
+            field.clear();
+        }
+        else if(c == '\n')
+        {
+            setCell(row, column, field);
+            field.clear();
+            row++;
+            column = 1;
+        }
+        else if(c != '\r')
+        {
+            field.append(c);
+        }
+    }
+
+    if(!field.isEmpty() || column > 1)
+        setCell(row, column, field);
+
+    return true;
+}
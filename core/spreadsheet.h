@@ -0,0 +1,67 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SPREADSHEET_H
+#define SPREADSHEET_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+class QByteArray;
+
+// In-memory copy of the first worksheet of an .xlsx (Office Open XML) or
+// .csv file. The whole sheet is read in a single pass; cells are addressed
+// like Excel's Cells(row, column), both starting at 1.
+class SpreadSheet
+{
+    Q_DECLARE_TR_FUNCTIONS(SpreadSheet)
+
+public:
+    SpreadSheet();
+
+    bool load(const QString &filePath);
+
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+    int rowCount() const
+    {
+        return m_rows.count();
+    }
+    QString cell(int row, int column) const;
+    int intCell(int row, int column) const;
+    QStringList row(int row) const;
+
+private:
+    QList<QStringList> m_rows;
+    QString m_errorString;
+
+    bool loadXlsx(const QString &filePath);
+    bool loadCsv(const QString &filePath);
+
+    bool readSharedStrings(const QByteArray &xml, QStringList *strings);
+    QString firstSheetPath(const QByteArray &workbook, const QByteArray &relations);
+    bool readSheet(const QByteArray &xml, const QStringList &sharedStrings);
+    void setCell(int row, int column, const QString &value);
+};
+
+#endif // SPREADSHEET_H
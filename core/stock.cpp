@@ -17,9 +17,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 **********************************************************************/
 
 #include "stock.h"
+#include "component.h"
 
-Stock::Stock(Package *package, QObject *parent) :
-    QObject(parent),
-    m_package(package)
+Stock::Stock(Package *package) :
+    m_component(0),
+    m_package(package),
+    m_stock(0),
+    m_lowValue(0)
 {
 }
+
+void Stock::setStock(int stock)
+{
+    if(m_component)
+        m_component->stockChanged(stock - m_stock);
+
+    m_stock = stock;
+}
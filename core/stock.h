@@ -19,26 +19,29 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef STOCK_H
 #define STOCK_H
 
-#include <QObject>
+#include <QtGlobal>
 
 class Package;
+class Component;
 
-class Stock : public QObject
+// Stock of a component in one package, held by value in the component's
+// stock array. Changing the quantity keeps the component's total in step,
+// so copies read from Component::stocks() are for reading only; stocks
+// are changed through Component::stock().
+class Stock
 {
-    Q_OBJECT
+    friend class Component;
+
 public:
-    explicit Stock(Package *package, QObject *parent = 0);
+    explicit Stock(Package *package = 0);
 
-    Package *package()
+    Package *package() const
     {
         return m_package;
     }
 
-    void setStock(int stock)
-    {
-        m_stock = stock;
-    }
-    int stock()
+    void setStock(int stock);
+    int stock() const
     {
         return m_stock;
     }
@@ -47,20 +50,19 @@ public:
     {
         m_lowValue = low;
     }
-    int lowValue()
+    int lowValue() const
     {
         return m_lowValue;
     }
 
-signals:
-
-public slots:
-
 private:
+    Component *m_component;
     Package *m_package;
     int m_stock;
     int m_lowValue;
 
 };
 
+Q_DECLARE_TYPEINFO(Stock, Q_MOVABLE_TYPE);
+
 #endif // STOCK_H
@@ -0,0 +1,562 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "stockledger.h"
+#include "journal.h"
+
+#include <QDataStream>
+#include <QDebug>
+
+static const quint32 LedgerMagic = 0x434f4c31; // "COL1"
+static const int HeaderSize = 4;                // magic
+static const int BlockHeaderSize = 6;           // length, checksum
+
+static quint32 readUInt32(const char *p)
+{
+    return ((quint32)(uchar)p[0] << 24) | ((quint32)(uchar)p[1] << 16) |
+           ((quint32)(uchar)p[2] << 8) | (quint32)(uchar)p[3];
+}
+
+static void putVarint(QByteArray &out, quint64 value)
+{
+    while(value >= 0x80)
+    {
+        out.append((char)((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append((char)value);
+}
+
+static bool getVarint(const QByteArray &in, int *pos, quint64 *value)
+{
+    quint64 result = 0;
+    for(int shift = 0; *pos < in.size() && shift < 64; shift += 7)
+    {
+        uchar c = in.at((*pos)++);
+        result |= (quint64)(c & 0x7f) << shift;
+        if(!(c & 0x80))
+        {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Small deltas of either sign take a single byte
+static quint32 zigzag(qint32 value)
+{
+    return ((quint32)value << 1) ^ (quint32)(value >> 31);
+}
+
+static qint32 unzigzag(quint32 value)
+{
+    return (qint32)(value >> 1) ^ -(qint32)(value & 1);
+}
+
+StockLedger::StockLedger()
+{
+}
+
+// Opens the ledger, or creates an empty one, and loads its intact blocks.
+// A block torn by a crash is cut off.
+bool StockLedger::open(const QString &filePath)
+{
+    close();
+    m_file.setFileName(filePath);
+
+    if(!m_file.open(QIODevice::ReadWrite))
+    {
+        m_errorString = m_file.errorString();
+        qDebug() << "Unable to open stock ledger:" << m_errorString;
+        return false;
+    }
+
+    QByteArray data = m_file.readAll();
+
+    if(data.isEmpty())
+    {
+        QDataStream stream(&m_file);
+        stream << LedgerMagic;
+        return m_file.flush() && Journal::sync(m_file);
+    }
+
+    // History is not thrown away: a file that is not a ledger stays as it is
+    if(data.size() < HeaderSize || readUInt32(data.constData()) != LedgerMagic)
+    {
+        m_errorString = tr("Not a stock ledger");
+        qDebug() << "Not a stock ledger:" << filePath;
+        m_file.close();
+        return false;
+    }
+
+    int offset = HeaderSize;
+    while(offset + BlockHeaderSize <= data.size())
+    {
+        const char *p = data.constData() + offset;
+        quint32 length = readUInt32(p);
+        quint16 checksum = ((quint16)(uchar)p[4] << 8) | (uchar)p[5];
+
+        if(length > (quint32)(data.size() - offset - BlockHeaderSize) ||
+                qChecksum(p + BlockHeaderSize, length) != checksum ||
+                !readBlock(QByteArray(p + BlockHeaderSize, length)))
+            break;
+
+        offset += BlockHeaderSize + length;
+    }
+
+    if(offset != data.size())
+    {
+        qDebug() << "ledger: dropping" << data.size() - offset << "bytes of incomplete block";
+        m_file.resize(offset);
+    }
+
+    m_file.seek(offset);
+
+    return true;
+}
+
+// Cuts the ledger back to 'size' bytes, as given by size() before an
+// append, and loads it again. Takes back a block whose movements could
+// not be booked after all.
+bool StockLedger::truncate(qint64 size)
+{
+    if(!isOpen() || size > m_file.size())
+        return false;
+
+    QString filePath = m_file.fileName();
+    if(!m_file.resize(size))
+    {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    return open(filePath);
+}
+
+void StockLedger::close()
+{
+    if(m_file.isOpen())
+        m_file.close();
+    clear();
+}
+
+void StockLedger::clear()
+{
+    m_strings.clear();
+    m_stringIndex.clear();
+    m_partName.clear();
+    m_partByName.clear();
+    m_keyPart.clear();
+    m_keyPackage.clear();
+    m_keyIndex.clear();
+
+    m_times.clear();
+    m_keys.clear();
+    m_deltas.clear();
+    m_reasons.clear();
+    m_references.clear();
+
+    m_net.clear();
+    m_consumed.clear();
+    m_snapshots.clear();
+}
+
+// Writes the entries as one block and waits until it is on disk. Times
+// going back (a clock set back) are raised to the last one, so the
+// history stays in time order. A block that fails to write is cut off
+// again, so the blocks appended after it are not lost on the next open().
+bool StockLedger::append(const QList<Entry> &entries)
+{
+    m_errorString.clear();
+
+    if(!isOpen())
+    {
+        m_errorString = tr("Stock ledger not open");
+        return false;
+    }
+    if(entries.isEmpty())
+        return true;
+
+    QStringList newStrings;
+    QHash<QString, int> newStringIndex;
+    QByteArray newKeys;
+    QHash<quint64, int> newKeyIndex;
+    int keyCount = m_keyPart.size();
+
+    QByteArray times, keys, deltas, reasons, references;
+    qint64 baseTime = m_times.isEmpty() ? entries.first().time.toMSecsSinceEpoch() : m_times.last();
+    qint64 previous = baseTime;
+
+    foreach(const Entry &e, entries)
+    {
+        // Names to numbers, new names numbered after the known ones
+        int ids[3];
+        QString names[3] = { e.component, e.package, e.reference };
+        for(int i = 0; i < 3; i++)
+        {
+            ids[i] = m_stringIndex.value(names[i], -1);
+            if(ids[i] < 0)
+                ids[i] = newStringIndex.value(names[i], -1);
+            if(ids[i] < 0 && (i < 2 || !names[i].isEmpty()))
+            {
+                ids[i] = m_strings.count() + newStrings.count();
+                newStringIndex.insert(names[i], ids[i]);
+                newStrings.append(names[i]);
+            }
+        }
+
+        // A new key is written as name and package; readBlock() finds the
+        // name's part the same way, from the renames of earlier blocks
+        int part = m_partByName.value(ids[0], -1);
+        int key = (part < 0) ? -1 : m_keyIndex.value(((quint64)part << 32) | (quint32)ids[1], -1);
+
+        quint64 pair = ((quint64)ids[0] << 32) | (quint32)ids[1];
+        if(key < 0)
+            key = newKeyIndex.value(pair, -1);
+        if(key < 0)
+        {
+            key = keyCount++;
+            newKeyIndex.insert(pair, key);
+            putVarint(newKeys, ids[0]);
+            putVarint(newKeys, ids[1]);
+        }
+
+        qint64 time = qMax(e.time.toMSecsSinceEpoch(), previous);
+        putVarint(times, time - previous);
+        previous = time;
+
+        putVarint(keys, key);
+        putVarint(deltas, zigzag(e.delta));
+        reasons.append((char)e.reason);
+        putVarint(references, ids[2] + 1);
+    }
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_7);
+    stream << (quint32)entries.count() << newStrings << (quint32)newKeyIndex.count() << newKeys
+           << baseTime << times << keys << deltas << reasons << references;
+
+    QByteArray block;
+    QDataStream out(&block, QIODevice::WriteOnly);
+    out << (quint32)payload.size() << qChecksum(payload.constData(), payload.size());
+    out.writeRawData(payload.constData(), payload.size());
+
+    qint64 offset = m_file.pos();
+    if(m_file.write(block) != block.size() || !m_file.flush() || !Journal::sync(m_file))
+    {
+        m_errorString = m_file.errorString();
+        qDebug() << "Unable to write stock ledger:" << m_errorString;
+        m_file.resize(offset);
+        m_file.seek(offset);
+        return false;
+    }
+
+    // Loaded back the way open() does, so memory and file cannot disagree
+    if(!readBlock(payload))
+    {
+        m_errorString = tr("Stock ledger block does not decode");
+        m_file.resize(offset);
+        m_file.seek(offset);
+        return false;
+    }
+
+    return true;
+}
+
+// Moves the history of 'oldName' over to 'newName', in a block of its
+// own. Nothing is written for a name without history.
+bool StockLedger::rename(const QString &oldName, const QString &newName)
+{
+    if(oldName == newName || newName.isEmpty())
+        return true;
+
+    int c = m_stringIndex.value(oldName, -1);
+    if(c < 0 || !m_partByName.contains(c))
+        return true;
+
+    Entry e;
+    e.time = QDateTime::currentDateTime();
+    e.component = oldName;
+    e.delta = 0;
+    e.reason = Rename;
+    e.reference = newName;
+
+    return append(QList<Entry>() << e);
+}
+
+// Decodes a block and adds it to the columns; nothing is added when the
+// block does not decode completely
+bool StockLedger::readBlock(const QByteArray &payload)
+{
+    QDataStream stream(payload);
+    stream.setVersion(QDataStream::Qt_4_7);
+
+    quint32 count, keyCount;
+    QStringList newStrings;
+    QByteArray newKeys, times, keys, deltas, reasons, references;
+    qint64 baseTime;
+
+    stream >> count >> newStrings >> keyCount >> newKeys
+           >> baseTime >> times >> keys >> deltas >> reasons >> references;
+    if(stream.status() != QDataStream::Ok || (quint32)reasons.size() != count)
+        return false;
+
+    quint64 stringCount = m_strings.count() + newStrings.count();
+    QVector<int> keyComponents, keyPackages;
+    int pos = 0;
+    for(quint32 i = 0; i < keyCount; i++)
+    {
+        quint64 component, package;
+        if(!getVarint(newKeys, &pos, &component) || !getVarint(newKeys, &pos, &package) ||
+                component >= stringCount || package >= stringCount)
+            return false;
+        keyComponents.append(component);
+        keyPackages.append(package);
+    }
+
+    quint64 totalKeys = m_keyPart.size() + keyCount;
+    QVector<qint64> entryTimes(count);
+    QVector<int> entryKeys(count), entryReferences(count);
+    QVector<qint32> entryDeltas(count);
+    int timePos = 0, keyPos = 0, deltaPos = 0, referencePos = 0;
+    qint64 time = baseTime;
+
+    for(quint32 i = 0; i < count; i++)
+    {
+        quint64 step, key, delta, reference;
+        if(!getVarint(times, &timePos, &step) || !getVarint(keys, &keyPos, &key) ||
+                !getVarint(deltas, &deltaPos, &delta) || !getVarint(references, &referencePos, &reference) ||
+                key >= totalKeys || reference > stringCount)
+            return false;
+
+        time += step;
+        entryTimes[i] = time;
+        entryKeys[i] = key;
+        entryDeltas[i] = unzigzag(delta);
+        entryReferences[i] = (int)reference - 1;
+    }
+
+    foreach(const QString &s, newStrings)
+    {
+        m_stringIndex.insert(s, m_strings.count());
+        m_strings.append(s);
+    }
+
+    for(int i = 0; i < keyComponents.size(); i++)
+    {
+        int part = m_partByName.value(keyComponents.at(i), -1);
+        if(part < 0)
+        {
+            part = m_partName.size();
+            m_partName.append(keyComponents.at(i));
+            m_partByName.insert(keyComponents.at(i), part);
+        }
+
+        quint64 pair = ((quint64)part << 32) | (quint32)keyPackages.at(i);
+        m_keyIndex.insert(pair, m_keyPart.size());
+        m_keyPart.append(part);
+        m_keyPackage.append(keyPackages.at(i));
+    }
+
+    for(quint32 i = 0; i < count; i++)
+        addEntry(entryTimes.at(i), entryKeys.at(i), entryDeltas.at(i), reasons.at(i), entryReferences.at(i));
+
+    return true;
+}
+
+void StockLedger::addEntry(qint64 time, int key, qint32 delta, quint8 reason, int reference)
+{
+    if(m_times.size() % SnapshotInterval == 0)
+    {
+        Snapshot snapshot;
+        snapshot.net = m_net;
+        snapshot.consumed = m_consumed;
+        m_snapshots.append(snapshot);
+    }
+
+    m_times.append(time);
+    m_keys.append(key);
+    m_deltas.append(delta);
+    m_reasons.append(reason);
+    m_references.append(reference);
+
+    if(key >= m_net.size())
+    {
+        m_net.resize(key + 1);
+        m_consumed.resize(key + 1);
+    }
+
+    m_net[key] += delta;
+    if(reason != Manual)
+        m_consumed[key] -= delta;
+
+    if(reason == Rename && reference >= 0)
+    {
+        int part = m_keyPart.at(key);
+        m_partByName.remove(m_partName.at(part));
+        m_partByName.insert(reference, part);
+        m_partName[part] = reference;
+    }
+}
+
+StockLedger::Entry StockLedger::entry(int index) const
+{
+    Entry e;
+    e.time = QDateTime::fromMSecsSinceEpoch(m_times.at(index));
+    e.component = m_strings.at(m_partName.at(m_keyPart.at(m_keys.at(index))));
+    e.package = m_strings.at(m_keyPackage.at(m_keys.at(index)));
+    e.delta = m_deltas.at(index);
+    e.reason = m_reasons.at(index);
+    if(m_references.at(index) >= 0)
+        e.reference = m_strings.at(m_references.at(index));
+    return e;
+}
+
+// Number of entries up to and including 'time'; all of them for an
+// invalid time
+int StockLedger::entriesUntil(const QDateTime &time) const
+{
+    if(!time.isValid())
+        return m_times.size();
+    return qUpperBound(m_times.begin(), m_times.end(), time.toMSecsSinceEpoch()) - m_times.begin();
+}
+
+// Totals of the first 'index' entries: the snapshot before them plus what
+// followed it
+void StockLedger::totalsAt(int index, QVector<qint64> *net, QVector<qint64> *consumed) const
+{
+    net->fill(0, m_keyPart.size());
+    consumed->fill(0, m_keyPart.size());
+    if(m_snapshots.isEmpty())
+        return;
+
+    int s = qMin(index / SnapshotInterval, m_snapshots.size() - 1);
+    const Snapshot &snapshot = m_snapshots.at(s);
+    for(int key = 0; key < snapshot.net.size(); key++)
+    {
+        (*net)[key] = snapshot.net.at(key);
+        (*consumed)[key] = snapshot.consumed.at(key);
+    }
+
+    for(int i = s * SnapshotInterval; i < index; i++)
+    {
+        (*net)[m_keys.at(i)] += m_deltas.at(i);
+        if(m_reasons.at(i) != Manual)
+            (*consumed)[m_keys.at(i)] -= m_deltas.at(i);
+    }
+}
+
+void StockLedger::keyTotalsAt(int index, int key, qint64 *net, qint64 *consumed) const
+{
+    *net = 0;
+    *consumed = 0;
+    if(m_snapshots.isEmpty())
+        return;
+
+    int s = qMin(index / SnapshotInterval, m_snapshots.size() - 1);
+    const Snapshot &snapshot = m_snapshots.at(s);
+    if(key < snapshot.net.size())
+    {
+        *net = snapshot.net.at(key);
+        *consumed = snapshot.consumed.at(key);
+    }
+
+    for(int i = s * SnapshotInterval; i < index; i++)
+    {
+        if(m_keys.at(i) != key)
+            continue;
+        *net += m_deltas.at(i);
+        if(m_reasons.at(i) != Manual)
+            *consumed -= m_deltas.at(i);
+    }
+}
+
+// Sum of the movements after 'from' up to 'to' (an invalid 'to' meaning
+// up to now). Today's stock minus netChange(at, QDateTime()) is the stock
+// at 'at'.
+qint64 StockLedger::netChange(const QString &component, const QString &package,
+                              const QDateTime &from, const QDateTime &to) const
+{
+    int key = findKey(component, package);
+    if(key < 0)
+        return 0;
+
+    qint64 netFrom, netTo, consumed;
+    keyTotalsAt(entriesUntil(from), key, &netFrom, &consumed);
+    keyTotalsAt(entriesUntil(to), key, &netTo, &consumed);
+    return netTo - netFrom;
+}
+
+// Key of the part now called 'component', in 'package'; -1 without history
+int StockLedger::findKey(const QString &component, const QString &package) const
+{
+    int c = m_stringIndex.value(component, -1);
+    int p = m_stringIndex.value(package, -1);
+    if(c < 0 || p < 0)
+        return -1;
+
+    int part = m_partByName.value(c, -1);
+    if(part < 0)
+        return -1;
+
+    return m_keyIndex.value(((quint64)part << 32) | (quint32)p, -1);
+}
+
+// Movements of every part after 'from' up to 'to', for parts that moved
+QList<StockLedger::Usage> StockLedger::usage(const QDateTime &from, const QDateTime &to) const
+{
+    QVector<qint64> netFrom, consumedFrom, netTo, consumedTo;
+    totalsAt(entriesUntil(from), &netFrom, &consumedFrom);
+    totalsAt(entriesUntil(to), &netTo, &consumedTo);
+
+    QList<Usage> list;
+    for(int key = 0; key < m_keyPart.size(); key++)
+    {
+        Usage u;
+        u.net = netTo.at(key) - netFrom.at(key);
+        u.consumed = consumedTo.at(key) - consumedFrom.at(key);
+        if(u.net == 0 && u.consumed == 0)
+            continue;
+
+        u.component = m_strings.at(m_partName.at(m_keyPart.at(key)));
+        u.package = m_strings.at(m_keyPackage.at(key));
+        list.append(u);
+    }
+
+    return list;
+}
+
+QString StockLedger::reasonName(quint8 reason)
+{
+    switch(reason)
+    {
+        case Manual:
+            return tr("manual");
+        case KitReduce:
+            return tr("kit reduce");
+        case KitAdd:
+            return tr("kit add");
+        case KitRollback:
+            return tr("kit rollback");
+        case Rename:
+            return tr("rename");
+    }
+    return tr("unknown");
+}
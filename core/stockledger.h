@@ -0,0 +1,152 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef STOCKLEDGER_H
+#define STOCKLEDGER_H
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QDateTime>
+
+// Append-only history of stock movements, kept next to data.xml. Each
+// append writes one block framed like the journal's records; inside a
+// block the movements are stored column by column (times, parts, deltas,
+// reasons, references), varint packed, with names replaced by numbers
+// from a dictionary that grows block by block.
+//
+// Movements belong to parts, not names. A part is created the first time
+// a component name is seen; a Rename entry moves the name over to the
+// new one, so a renamed component keeps its history and a later component
+// taking the old name starts a history of its own.
+//
+// In memory the columns are kept as vectors, and every SnapshotInterval
+// movements the running totals of each part are saved. A point-in-time
+// query starts from the closest snapshot and replays at most one interval.
+class StockLedger
+{
+    Q_DECLARE_TR_FUNCTIONS(StockLedger)
+
+public:
+    enum Reason
+    {
+        Manual = 0,         // edited in the component dialog
+        KitReduce,          // taken out by a BOM kit
+        KitAdd,             // put back by a BOM kit
+        KitRollback,        // kit undone
+        Rename              // 'component' renamed to 'reference', no delta
+    };
+
+    enum { SnapshotInterval = 4096 };
+
+    struct Entry
+    {
+        QDateTime time;
+        QString component;
+        QString package;
+        qint32 delta;
+        quint8 reason;
+        QString reference;  // BOM file(s), empty for manual edits
+    };
+
+    struct Usage
+    {
+        QString component;
+        QString package;
+        qint64 consumed;    // taken out by kits
+        qint64 net;         // every movement
+    };
+
+    StockLedger();
+
+    bool open(const QString &filePath);
+    void close();
+    bool isOpen() const
+    {
+        return m_file.isOpen();
+    }
+
+    bool append(const QList<Entry> &entries);
+    bool rename(const QString &oldName, const QString &newName);
+    qint64 size() const
+    {
+        return m_file.size();
+    }
+    bool truncate(qint64 size);
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+    int count() const
+    {
+        return m_times.size();
+    }
+    Entry entry(int index) const;
+
+    qint64 netChange(const QString &component, const QString &package,
+                     const QDateTime &from, const QDateTime &to) const;
+    QList<Usage> usage(const QDateTime &from, const QDateTime &to) const;
+
+    static QString reasonName(quint8 reason);
+
+private:
+    struct Snapshot
+    {
+        QVector<qint64> net;        // per key, before the snapshot's first entry
+        QVector<qint64> consumed;
+    };
+
+    QFile m_file;
+    QString m_errorString;
+
+    // Dictionary
+    QStringList m_strings;
+    QHash<QString, int> m_stringIndex;
+    QVector<int> m_partName;            // part -> string, its current name
+    QHash<int, int> m_partByName;       // string -> part
+    QVector<int> m_keyPart;             // key -> part
+    QVector<int> m_keyPackage;          // key -> string
+    QHash<quint64, int> m_keyIndex;     // part << 32 | package -> key
+
+    // Columns
+    QVector<qint64> m_times;            // ms since epoch, never decreasing
+    QVector<int> m_keys;
+    QVector<qint32> m_deltas;
+    QVector<quint8> m_reasons;
+    QVector<int> m_references;          // string, -1 for none
+
+    // Index
+    QVector<qint64> m_net;
+    QVector<qint64> m_consumed;
+    QList<Snapshot> m_snapshots;
+
+    void clear();
+    bool readBlock(const QByteArray &payload);
+    void addEntry(qint64 time, int key, qint32 delta, quint8 reason, int reference);
+    int entriesUntil(const QDateTime &time) const;
+    void totalsAt(int index, QVector<qint64> *net, QVector<qint64> *consumed) const;
+    void keyTotalsAt(int index, int key, qint64 *net, qint64 *consumed) const;
+    int findKey(const QString &component, const QString &package) const;
+};
+
+#endif // STOCKLEDGER_H
@@ -0,0 +1,157 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "stockreservation.h"
+#include "component.h"
+#include "stock.h"
+#include "package.h"
+
+StockReservation::StockReservation(CO *co) :
+    m_co(co),
+    m_demand(co)
+{
+}
+
+// Adds the parts of 'boards' boards, taken out of stock when 'boards' is
+// negative
+void StockReservation::addBom(const Bom &bom, int boards)
+{
+    m_demand.addBom(bom, boards);
+}
+
+void StockReservation::clear()
+{
+    m_demand.clear();
+    m_committed.clear();
+    m_errorString.clear();
+}
+
+bool StockReservation::isShort(const BomDemand::Part &part)
+{
+    if(part.stock == 0)
+        return true;
+    return part.quantity < 0 && part.stock->stock() < -part.quantity;
+}
+
+// Parts that cannot be taken out of stock in full, and parts missing from
+// the library or without a stock
+QList<Bom::Shortage> StockReservation::shortages() const
+{
+    QList<Bom::Shortage> list;
+
+    foreach(const BomDemand::Part &part, m_demand.parts())
+    {
+        if(!isShort(part))
+            continue;
+
+        Bom::Shortage shortage;
+        shortage.partNumber = part.partNumber;
+        shortage.designators = part.designators;
+        shortage.missing = (part.component == 0);
+        shortage.required = qMax(-part.quantity, 0);
+        shortage.available = (part.stock != 0) ? part.stock->stock() : 0;
+        list.append(shortage);
+    }
+
+    return list;
+}
+
+// Part numbers commit() leaves out: not in the library or without stock
+QStringList StockReservation::skipped() const
+{
+    QStringList list;
+    foreach(const BomDemand::Part &part, m_demand.parts())
+        if(part.stock == 0)
+            list.append(part.partNumber);
+    return list;
+}
+
+// Books the whole kit. Unless forced, a kit taking out more than is in
+// stock, or needing a part that cannot be booked, is refused untouched.
+bool StockReservation::commit(bool force)
+{
+    m_errorString.clear();
+
+    if(isCommitted())
+    {
+        m_errorString = tr("Already committed");
+        return false;
+    }
+
+    QList<CO::StockMove> moves;
+    foreach(const BomDemand::Part &part, m_demand.parts())
+    {
+        if(isShort(part) && !force)
+        {
+            m_errorString = tr("Not enough stock");
+            return false;
+        }
+
+        if(part.stock == 0 || part.quantity == 0)
+            continue;
+
+        CO::StockMove move;
+        move.component = part.component;
+        move.stock = part.stock;
+        move.delta = part.quantity;
+        moves.append(move);
+    }
+
+    if(!m_co->moveStock(moves, m_reference, false, &m_errorString))
+        return false;
+
+    foreach(const CO::StockMove &move, moves)
+    {
+        CommittedMove committed;
+        committed.partNumber = move.component->name();
+        committed.componentId = move.component->ID();
+        committed.packageId = move.stock->package()->nameId();
+        committed.delta = move.delta;
+        m_committed.append(committed);
+    }
+    return true;
+}
+
+// Books the committed moves back. Refused as a whole when a part or its
+// stock has been removed since.
+bool StockReservation::rollback()
+{
+    m_errorString.clear();
+
+    QList<CO::StockMove> moves;
+    foreach(const CommittedMove &committed, m_committed)
+    {
+        CO::StockMove move;
+        move.component = m_co->findComponent(committed.componentId);
+        move.stock = (move.component != 0) ? move.component->stockById(committed.packageId) : 0;
+        move.delta = -committed.delta;
+
+        if(move.stock == 0)
+        {
+            m_errorString = tr("Part no longer in stock: %1").arg(committed.partNumber);
+            return false;
+        }
+        moves.append(move);
+    }
+
+    if(!m_co->moveStock(moves, m_reference, true, &m_errorString))
+        return false;
+
+    m_committed.clear();
+    return true;
+}
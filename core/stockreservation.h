@@ -0,0 +1,91 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef STOCKRESERVATION_H
+#define STOCKRESERVATION_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+#include "bom.h"
+#include "bomdemand.h"
+#include "co.h"
+
+// Kit of one or more BOMs booked against stock as a whole. The BOM lines
+// are merged per part first (see BomDemand), so a part used by several
+// BOMs is checked against its total; commit() then books every part in one
+// CO::moveStock() and rollback() undoes a committed kit the same way. The
+// committed moves are kept by component and package ID, so a rollback
+// finds the stocks again after later edits.
+class StockReservation
+{
+    Q_DECLARE_TR_FUNCTIONS(StockReservation)
+
+public:
+    explicit StockReservation(CO *co);
+
+    void addBom(const Bom &bom, int boards);
+    void clear();
+
+    // Written to the stock ledger with the moves, e.g. the BOM file names
+    void setReference(const QString &reference)
+    {
+        m_reference = reference;
+    }
+
+    bool isEmpty() const
+    {
+        return m_demand.isEmpty();
+    }
+
+    QList<Bom::Shortage> shortages() const;
+    QStringList skipped() const;
+
+    bool commit(bool force = false);
+    bool rollback();
+
+    bool isCommitted() const
+    {
+        return !m_committed.isEmpty();
+    }
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+private:
+    struct CommittedMove
+    {
+        QString partNumber;
+        int componentId;
+        int packageId;                  // pooled package name ID
+        int delta;
+    };
+
+    CO *m_co;
+    BomDemand m_demand;                 // quantity is the stock delta
+    QList<CommittedMove> m_committed;
+    QString m_reference;
+    QString m_errorString;
+
+    static bool isShort(const BomDemand::Part &part);
+};
+
+#endif // STOCKRESERVATION_H
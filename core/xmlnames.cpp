@@ -0,0 +1,133 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "xmlnames.h"
+
+namespace
+{
+
+struct Entry
+{
+    const char *name;
+    XmlNames::Name id;
+};
+
+const Entry names[] =
+{
+    { "comporg", XmlNames::Comporg },
+    { "version", XmlNames::Version },
+    { "journal", XmlNames::Journal },
+    { "manufacturers", XmlNames::Manufacturers },
+    { "manufacturer", XmlNames::Manufacturer },
+    { "packages", XmlNames::Packages },
+    { "package", XmlNames::Package },
+    { "containers", XmlNames::Containers },
+    { "container", XmlNames::Container },
+    { "labels", XmlNames::Labels },
+    { "label", XmlNames::Label },
+    { "ntop", XmlNames::Ntop },
+    { "levels", XmlNames::Levels },
+    { "leafs", XmlNames::Leafs },
+    { "level", XmlNames::Level },
+    { "components", XmlNames::Components },
+    { "component", XmlNames::Component },
+    { "description", XmlNames::Description },
+    { "notes", XmlNames::Notes },
+    { "datasheets", XmlNames::Datasheets },
+    { "datasheet", XmlNames::Datasheet },
+    { "default", XmlNames::Default },
+    { "link", XmlNames::Link },
+    { "type", XmlNames::Type },
+    { "path", XmlNames::Path },
+    { "stocks", XmlNames::Stocks },
+    { "stock", XmlNames::Stock },
+    { "ignore", XmlNames::Ignore },
+    { "value", XmlNames::Value },
+    { "low", XmlNames::Low },
+    { "appnotes", XmlNames::Appnotes },
+    { "appnote", XmlNames::Appnote },
+    { "attachedFile", XmlNames::AttachedFile },
+    { "name", XmlNames::NameAttribute },
+    { "n", XmlNames::Count }
+};
+
+const int nameCount = sizeof(names) / sizeof(names[0]);
+const int tableSize = 128;      // power of two, well above nameCount
+
+inline int slot(const QChar *c, int length, quint32 multiplier)
+{
+    quint32 h = 0;
+    for(int i = 0; i < length; i++)
+        h = h * multiplier + c[i].unicode();
+
+    return (h ^ (h >> 16)) & (tableSize - 1);
+}
+
+inline int slot(const char *c, quint32 multiplier)
+{
+    quint32 h = 0;
+    for(; *c; c++)
+        h = h * multiplier + (uchar) *c;
+
+    return (h ^ (h >> 16)) & (tableSize - 1);
+}
+
+class Table
+{
+public:
+    Table() :
+        multiplier(1)
+    {
+        while(!build())
+            multiplier++;
+    }
+
+    quint32 multiplier;
+    const Entry *entries[tableSize];
+
+private:
+    bool build()
+    {
+        for(int i = 0; i < tableSize; i++)
+            entries[i] = 0;
+
+        for(int i = 0; i < nameCount; i++)
+        {
+            int s = slot(names[i].name, multiplier);
+            if(entries[s])
+                return false;
+            entries[s] = &names[i];
+        }
+
+        return true;
+    }
+};
+
+const Table table;
+
+}
+
+XmlNames::Name XmlNames::lookup(const QStringRef &name)
+{
+    const Entry *entry = table.entries[slot(name.unicode(), name.size(), table.multiplier)];
+
+    if(entry && name == QLatin1String(entry->name))
+        return entry->id;
+
+    return Unknown;
+}
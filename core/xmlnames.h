@@ -0,0 +1,78 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef XMLNAMES_H
+#define XMLNAMES_H
+
+#include <QString>
+#include <QStringRef>
+
+// Element and attribute names of data.xml. The reader switches on these
+// instead of comparing strings or relying on positions, so attributes
+// may come in any order and names it does not know are passed over.
+//
+// The names are placed in a perfect hash table: the hash multiplier is
+// searched once, when the table is built, until every name has a slot of
+// its own. A lookup is then one hash over the characters and one compare.
+class XmlNames
+{
+public:
+    enum Name
+    {
+        Unknown = 0,
+        Comporg,
+        Version,
+        Journal,
+        Manufacturers,
+        Manufacturer,
+        Packages,
+        Package,
+        Containers,
+        Container,
+        Labels,
+        Label,
+        Ntop,
+        Levels,
+        Leafs,
+        Level,
+        Components,
+        Component,
+        Description,
+        Notes,
+        Datasheets,
+        Datasheet,
+        Default,
+        Link,
+        Type,
+        Path,
+        Stocks,
+        Stock,
+        Ignore,
+        Value,
+        Low,
+        Appnotes,
+        Appnote,
+        AttachedFile,
+        NameAttribute,      // "name"
+        Count               // "n"
+    };
+
+    static Name lookup(const QStringRef &name);
+};
+
+#endif // XMLNAMES_H
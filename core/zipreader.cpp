@@ -0,0 +1,511 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "zipreader.h"
+
+#include <QFile>
+
+#include <QDebug>
+
+namespace
+{
+
+// Raw DEFLATE (RFC 1951) decoder. Canonical Huffman codes are decoded bit by
+// bit, which is plenty fast for the few hundred kilobytes of a spreadsheet.
+
+enum
+{
+    MaxBits = 15,
+    MaxLengthCodes = 286,
+    MaxDistanceCodes = 30,
+    FixedLengthCodes = 288
+};
+
+struct Huffman
+{
+    short count[MaxBits + 1];
+    short symbol[FixedLengthCodes];
+};
+
+struct InflateState
+{
+    const uchar *in;
+    int inSize;
+    int inPos;
+    quint32 bitBuffer;
+    int bitCount;
+    bool error;
+    QByteArray *out;
+};
+
+int bits(InflateState *s, int need)
+{
+    quint32 value = s->bitBuffer;
+
+    while(s->bitCount < need)
+    {
+        if(s->inPos >= s->inSize)
+        {
+            s->error = true;
+            return 0;
+        }
+        value |= (quint32) s->in[s->inPos++] << s->bitCount;
+        s->bitCount += 8;
+    }
+
+    s->bitBuffer = value >> need;
+    s->bitCount -= need;
+
+    return (int)(value & ((1U << need) - 1));
+}
+
+bool stored(InflateState *s)
+{
+    // Stored blocks start on a byte boundary
+    s->bitBuffer = 0;
+    s->bitCount = 0;
+
+    if(s->inPos + 4 > s->inSize)
+        return false;
+
+    int length = s->in[s->inPos] | (s->in[s->inPos + 1] << 8);
+    int complement = s->in[s->inPos + 2] | (s->in[s->inPos + 3] << 8);
+    s->inPos += 4;
+
+    if(length != (~complement & 0xffff) || s->inPos + length > s->inSize)
+        return false;
+
+    s->out->append((const char *) s->in + s->inPos, length);
+    s->inPos += length;
+
+    return true;
+}
+
+int decode(InflateState *s, const Huffman *h)
+{
+    int code = 0;
+    int first = 0;
+    int index = 0;
+
+    for(int len = 1; len <= MaxBits; len++)
+    {
+        code |= bits(s, 1);
+        if(s->error)
+            return -1;
+
+        int count = h->count[len];
+        if(code - count < first)
+            return h->symbol[index + (code - first)];
+
+        index += count;
+        first += count;
+        first <<= 1;
+        code <<= 1;
+    }
+
+    return -1;
+}
+
+// Returns 0 for a complete code, a positive value for an incomplete one and
+// a negative value for an over-subscribed (invalid) code.
+int construct(Huffman *h, const short *length, int n)
+{
+    short offsets[MaxBits + 1];
+
+    for(int len = 0; len <= MaxBits; len++)
+        h->count[len] = 0;
+    for(int symbol = 0; symbol < n; symbol++)
+        h->count[length[symbol]]++;
+
+    if(h->count[0] == n)
+        return 0;
+
+    int left = 1;
+    for(int len = 1; len <= MaxBits; len++)
+    {
+        left <<= 1;
+        left -= h->count[len];
+        if(left < 0)
+            return left;
+    }
+
+    offsets[1] = 0;
+    for(int len = 1; len < MaxBits; len++)
+        offsets[len + 1] = offsets[len] + h->count[len];
+
+    for(int symbol = 0; symbol < n; symbol++)
+        if(length[symbol] != 0)
+            h->symbol[offsets[length[symbol]]++] = symbol;
+
+    return left;
+}
+
+bool codes(InflateState *s, const Huffman *lencode, const Huffman *distcode)
+{
+    static const short lengthBase[29] =
+    {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+    };
+    static const short lengthExtra[29] =
+    {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+    };
+    static const short distanceBase[30] =
+    {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+        8193, 12289, 16385, 24577
+    };
+    static const short distanceExtra[30] =
+    {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+        12, 12, 13, 13
+    };
+
+    forever
+    {
+        int symbol = decode(s, lencode);
+        if(symbol < 0)
+            return false;
+
+        if(symbol < 256)
+        {
+            s->out->append((char) symbol);
+        }
+        else if(symbol == 256)
+        {
+            return true;
+        }
+        else
+        {
+            symbol -= 257;
+            if(symbol >= 29)
+                return false;
+            int length = lengthBase[symbol] + bits(s, lengthExtra[symbol]);
+
+            symbol = decode(s, distcode);
+            if(symbol < 0 || symbol >= 30)
+                return false;
+            int distance = distanceBase[symbol] + bits(s, distanceExtra[symbol]);
+
+            if(s->error || distance > s->out->size())
+                return false;
+
+            // Byte by byte: source and destination may overlap
+            int from = s->out->size() - distance;
+            while(length-- > 0)
+                s->out->append(s->out->at(from++));
+        }
+    }
+}
+
+// The fixed codes are built once and shared read-only: archives may be
+// inflated from several threads at once (batch runs)
+struct FixedTables
+{
+    Huffman lencode;
+    Huffman distcode;
+
+    FixedTables()
+    {
+        short lengths[FixedLengthCodes];
+        int symbol = 0;
+
+        for(; symbol < 144; symbol++)
+            lengths[symbol] = 8;
+        for(; symbol < 256; symbol++)
+            lengths[symbol] = 9;
+        for(; symbol < 280; symbol++)
+            lengths[symbol] = 7;
+        for(; symbol < FixedLengthCodes; symbol++)
+            lengths[symbol] = 8;
+        construct(&lencode, lengths, FixedLengthCodes);
+
+        for(symbol = 0; symbol < MaxDistanceCodes; symbol++)
+            lengths[symbol] = 5;
+        construct(&distcode, lengths, MaxDistanceCodes);
+    }
+};
+
+Q_GLOBAL_STATIC(FixedTables, fixedTables)
+
+bool fixed(InflateState *s)
+{
+    const FixedTables *tables = fixedTables();
+    return codes(s, &tables->lencode, &tables->distcode);
+}
+
+bool dynamic(InflateState *s)
+{
+    static const short order[19] =
+    {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+    };
+
+    short lengths[MaxLengthCodes + MaxDistanceCodes];
+    Huffman lencode;
+    Huffman distcode;
+
+    int nlen = bits(s, 5) + 257;
+    int ndist = bits(s, 5) + 1;
+    int ncode = bits(s, 4) + 4;
+    if(s->error || nlen > MaxLengthCodes || ndist > MaxDistanceCodes)
+        return false;
+
+    int index;
+    for(index = 0; index < ncode; index++)
+        lengths[order[index]] = bits(s, 3);
+    for(; index < 19; index++)
+        lengths[order[index]] = 0;
+
+    if(s->error || construct(&lencode, lengths, 19) != 0)
+        return false;
+
+    index = 0;
+    while(index < nlen + ndist)
+    {
+        int symbol = decode(s, &lencode);
+        if(symbol < 0)
+            return false;
+
+        if(symbol < 16)
+        {
+            lengths[index++] = symbol;
+            continue;
+        }
+
+        short length = 0;
+        if(symbol == 16)
+        {
+            if(index == 0)
+                return false;
+            length = lengths[index - 1];
+            symbol = 3 + bits(s, 2);
+        }
+        else if(symbol == 17)
+            symbol = 3 + bits(s, 3);
+        else
+            symbol = 11 + bits(s, 7);
+
+        if(s->error || index + symbol > nlen + ndist)
+            return false;
+        while(symbol-- > 0)
+            lengths[index++] = length;
+    }
+
+    // A block without an end-of-block code can't be decoded
+    if(lengths[256] == 0)
+        return false;
+
+    int err = construct(&lencode, lengths, nlen);
+    if(err < 0 || (err > 0 && nlen - lencode.count[0] != 1))
+        return false;
+
+    err = construct(&distcode, lengths + nlen, ndist);
+    if(err < 0 || (err > 0 && ndist - distcode.count[0] != 1))
+        return false;
+
+    return codes(s, &lencode, &distcode);
+}
+
+bool inflateRaw(const uchar *data, int size, QByteArray *out)
+{
+    InflateState s;
+    s.in = data;
+    s.inSize = size;
+    s.inPos = 0;
+    s.bitBuffer = 0;
+    s.bitCount = 0;
+    s.error = false;
+    s.out = out;
+
+    int last;
+    do
+    {
+        last = bits(&s, 1);
+        int type = bits(&s, 2);
+        if(s.error)
+            return false;
+
+        bool ok;
+        switch(type)
+        {
+            case 0:
+                ok = stored(&s);
+                break;
+            case 1:
+                ok = fixed(&s);
+                break;
+            case 2:
+                ok = dynamic(&s);
+                break;
+            default:
+                ok = false;
+        }
+
+        if(!ok || s.error)
+            return false;
+    }
+    while(!last);
+
+    return true;
+}
+
+quint16 readLe16(const uchar *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+quint32 readLe32(const uchar *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((quint32) p[3] << 24);
+}
+
+const quint32 LocalHeaderSignature = 0x04034b50;
+const quint32 CentralHeaderSignature = 0x02014b50;
+const quint32 EndOfCentralDirectorySignature = 0x06054b50;
+
+}
+
+ZipReader::ZipReader(const QString &filePath) :
+    m_open(false)
+{
+    QFile file(filePath);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        m_errorString = file.errorString();
+        return;
+    }
+
+    m_data = file.readAll();
+    file.close();
+
+    m_open = readCentralDirectory();
+    if(!m_open)
+        m_data.clear();
+}
+
+bool ZipReader::readCentralDirectory()
+{
+    const uchar *data = (const uchar *) m_data.constData();
+    const int size = m_data.size();
+
+    // The end of central directory record is followed by at most 64k of comment
+    int eocd = -1;
+    for(int pos = size - 22; pos >= 0 && pos >= size - 22 - 0xffff; pos--)
+    {
+        if(readLe32(data + pos) == EndOfCentralDirectorySignature)
+        {
+            eocd = pos;
+            break;
+        }
+    }
+
+    if(eocd < 0)
+    {
+        m_errorString = tr("Not a ZIP archive");
+        return false;
+    }
+
+    int entries = readLe16(data + eocd + 10);
+    quint32 pos = readLe32(data + eocd + 16);
+
+    while(entries-- > 0)
+    {
+        if(pos + 46 > (quint32) size || readLe32(data + pos) != CentralHeaderSignature)
+        {
+            m_errorString = tr("Corrupted ZIP central directory");
+            return false;
+        }
+
+        Entry entry;
+        entry.method = readLe16(data + pos + 10);
+        entry.compressedSize = readLe32(data + pos + 20);
+        entry.uncompressedSize = readLe32(data + pos + 24);
+        quint16 nameLength = readLe16(data + pos + 28);
+        quint16 extraLength = readLe16(data + pos + 30);
+        quint16 commentLength = readLe16(data + pos + 32);
+        entry.localHeaderOffset = readLe32(data + pos + 42);
+
+        if(pos + 46 + nameLength > (quint32) size)
+        {
+            m_errorString = tr("Corrupted ZIP central directory");
+            return false;
+        }
+
+        QString name = QString::fromUtf8((const char *) data + pos + 46, nameLength);
+        m_entries.insert(name, entry);
+
+        pos += 46 + nameLength + extraLength + commentLength;
+    }
+
+    return true;
+}
+
+QByteArray ZipReader::fileData(const QString &name)
+{
+    if(!m_entries.contains(name))
+    {
+        m_errorString = tr("File not found in archive: ") + name;
+        return QByteArray();
+    }
+
+    const Entry entry = m_entries.value(name);
+    const uchar *data = (const uchar *) m_data.constData();
+    const quint32 size = m_data.size();
+
+    quint32 pos = entry.localHeaderOffset;
+    if(pos + 30 > size || readLe32(data + pos) != LocalHeaderSignature)
+    {
+        m_errorString = tr("Corrupted ZIP entry: ") + name;
+        return QByteArray();
+    }
+
+    pos += 30 + readLe16(data + pos + 26) + readLe16(data + pos + 28);
+    if(pos + entry.compressedSize > size)
+    {
+        m_errorString = tr("Truncated ZIP entry: ") + name;
+        return QByteArray();
+    }
+
+    QByteArray result;
+
+    switch(entry.method)
+    {
+        case 0: // stored
+            result = QByteArray((const char *) data + pos, entry.compressedSize);
+            break;
+        case 8: // deflated
+            result.reserve(entry.uncompressedSize);
+            if(!inflateRaw(data + pos, entry.compressedSize, &result))
+            {
+                m_errorString = tr("Corrupted ZIP entry: ") + name;
+                return QByteArray();
+            }
+            break;
+        default:
+            m_errorString = tr("Unsupported ZIP compression method in ") + name;
+            return QByteArray();
+    }
+
+    return result;
+}
@@ -0,0 +1,73 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef ZIPREADER_H
+#define ZIPREADER_H
+
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+
+// Minimal read-only ZIP archive reader (stored and deflated entries), enough
+// to open Office Open XML files such as .xlsx without any external library.
+class ZipReader
+{
+    Q_DECLARE_TR_FUNCTIONS(ZipReader)
+
+public:
+    explicit ZipReader(const QString &filePath);
+
+    bool isOpen() const
+    {
+        return m_open;
+    }
+    QString errorString() const
+    {
+        return m_errorString;
+    }
+
+    QStringList fileNames() const
+    {
+        return m_entries.keys();
+    }
+    bool contains(const QString &name) const
+    {
+        return m_entries.contains(name);
+    }
+    QByteArray fileData(const QString &name);
+
+private:
+    struct Entry
+    {
+        quint16 method;
+        quint32 compressedSize;
+        quint32 uncompressedSize;
+        quint32 localHeaderOffset;
+    };
+
+    QByteArray m_data;
+    QHash<QString, Entry> m_entries;
+    bool m_open;
+    QString m_errorString;
+
+    bool readCentralDirectory();
+};
+
+#endif // ZIPREADER_H
@@ -34,6 +34,8 @@ ComponentDetails::ComponentDetails(CO *co, Component *component, QWidget *parent
     QDialog(parent),
     ui(new Ui::ComponentDetails),
     m_component(component),
+    m_stockModified(false),
+    m_componentModified(false),
     m_co(co)
 {
     ui->setupUi(this);
@@ -88,7 +90,7 @@ void ComponentDetails::setup()
             m_datasheetTable->setDefaultDatasheet(row);
     }
 
-    foreach(Stock *s, m_component->stocks())
+    foreach(const Stock &s, m_component->stocks())
     {
         m_stockTable->addStock(s);
     }
@@ -134,23 +136,38 @@ void ComponentDetails::updateStockTable()
     }
 }
 
+// Stock counts are journaled as stock deltas; the low values and notes
+// need the whole component to be saved again
 void ComponentDetails::accept()
 {
-    int total = 0;
+    m_stockModified = false;
+    m_componentModified = false;
 
     for(int row = 0; row < m_stockTable->rowCount(); row++)
     {
-        qDebug() << "update stock" << m_stockTable->package(row);
         QString packageName = m_stockTable->package(row);
         Stock *s = m_component->stock(packageName);
-        s->setStock(m_stockTable->stock(row));
-        s->setLowValue(m_stockTable->lowValue(row));
-
-        total += m_stockTable->stock(row);
+        int delta = m_stockTable->stock(row) - s->stock();
+        if(delta != 0)
+        {
+            qDebug() << "update stock" << packageName << delta;
+            m_co->recordStockEdit(m_component, packageName, delta);
+            s->setStock(m_stockTable->stock(row));
+            m_co->stockChanged(m_component, s, delta);
+            m_stockModified = true;
+        }
+        if(s->lowValue() != m_stockTable->lowValue(row))
+        {
+            s->setLowValue(m_stockTable->lowValue(row));
+            m_componentModified = true;
+        }
     }
-    m_component->setTotalStock(total);
 
-    m_component->setNotes(ui->notes_textEdit->toPlainText());
+    if(m_component->notes() != ui->notes_textEdit->toPlainText())
+    {
+        m_component->setNotes(ui->notes_textEdit->toPlainText());
+        m_componentModified = true;
+    }
 
     done(QDialog::Accepted);
 }
@@ -40,6 +40,17 @@ public:
     explicit ComponentDetails(CO *co, Component *component = 0, QWidget *parent = 0);
     ~ComponentDetails();
 
+    // What accept() changed: stock counts are already reported to CO as
+    // stock deltas, other edits need the whole component to be saved
+    bool stockModified() const
+    {
+        return m_stockModified;
+    }
+    bool componentModified() const
+    {
+        return m_componentModified;
+    }
+
 protected:
     void closeEvent(QCloseEvent *);
 
@@ -57,6 +68,8 @@ private:
     StockTable     *m_stockTable;
 
     Component *m_component;
+    bool m_stockModified;
+    bool m_componentModified;
 
     CO *m_co;
 };
@@ -80,7 +80,7 @@ ComponentDialog::ComponentDialog(CO *co, Component *toEdit, QWidget *parent) :
             m_datasheetTable->setDefaultDatasheet(row);
     }
 
-    foreach(Stock *s, toEdit->stocks())
+    foreach(const Stock &s, toEdit->stocks())
         m_stockTable->addStock(s);
 
     if(toEdit->ignoreStock())
@@ -336,7 +336,7 @@ Datasheet *ComponentDialog::createDatasheet(int row)
 
 void ComponentDialog::createComponent()
 {
-    Component *c = new Component(ui->name_lineEdit->text(), m_co);
+    Component *c = new Component(ui->name_lineEdit->text());
     c->setDescription(ui->description_lineEdit->text());
 
     for(int row = 0; row < m_datasheetTable->rowCount(); row++)
@@ -359,9 +359,9 @@ void ComponentDialog::createComponent()
         int stock = m_stockTable->stock(row);
         int lowValue = m_stockTable->lowValue(row);
 
-        Stock *s = new Stock(p);
-        s->setStock(stock);
-        s->setLowValue(lowValue);
+        Stock s(p);
+        s.setStock(stock);
+        s.setLowValue(lowValue);
 
         c->addStock(s);
     }
@@ -468,6 +468,7 @@ void ComponentDialog::updateStock()
         qDebug() << "update stock" << m_stockTable->package(row);
         QString packageName = m_stockTable->package(row);
         Stock *s = m_component->stock(packageName);
+        m_co->recordStockEdit(m_component, packageName, m_stockTable->stock(row) - s->stock());
         s->setStock(m_stockTable->stock(row));
         s->setLowValue(m_stockTable->lowValue(row));
     }
@@ -477,6 +478,9 @@ void ComponentDialog::updateStock()
     {
         qDebug() << "remove stock" << m_stockTable->package(row);
         QString packageName = m_stockTable->package(row);
+        Stock *s = m_component->stock(packageName);
+        if(s)
+            m_co->recordStockEdit(m_component, packageName, -s->stock());
         m_component->removeStock(packageName);
     }
 
@@ -485,16 +489,12 @@ void ComponentDialog::updateStock()
     {
         qDebug() << "add stock" << m_stockTable->package(row);
         Package *package = m_co->findPackage(m_stockTable->package(row));
-        Stock *stock = new Stock(package);
-        stock->setStock(m_stockTable->stock(row));
-        stock->setLowValue(m_stockTable->lowValue(row));
+        Stock stock(package);
+        stock.setStock(m_stockTable->stock(row));
+        stock.setLowValue(m_stockTable->lowValue(row));
         m_component->addStock(stock);
+        m_co->recordStockEdit(m_component, package->name(), stock.stock());
     }
-
-    int total = 0;
-    foreach(Stock *s, m_component->stocks())
-        total += s->stock();
-    m_component->setTotalStock(total);
 }
 
 void ComponentDialog::updateContainer()
@@ -617,7 +617,7 @@ void ComponentDialog::addStockHandler()
     stock.setStock(0);
     stock.setLowValue(1);
 
-    int row = m_stockTable->addStock(&stock);
+    int row = m_stockTable->addStock(stock);
 
     if(m_mode == ComponentDialog::Edit)
         m_stockTable->setRowColorHint(row, StockTable::addRowColorHint);
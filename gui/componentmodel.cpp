@@ -0,0 +1,347 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "componentmodel.h"
+#include "co.h"
+#include "component.h"
+#include "container.h"
+#include "stock.h"
+#include "stocktable.h"
+
+#include <QColor>
+
+namespace
+{
+
+class ComponentLessThan
+{
+public:
+    ComponentLessThan(int column, Qt::SortOrder order) :
+        m_column(column), m_order(order)
+    {
+    }
+
+    bool operator()(Component *a, Component *b) const
+    {
+        return (m_order == Qt::AscendingOrder) ? lessThan(a, b) : lessThan(b, a);
+    }
+
+private:
+    int m_column;
+    Qt::SortOrder m_order;
+
+    static int stockKey(Component *c)
+    {
+        return c->ignoreStock() ? -1 : c->totalStock();
+    }
+
+    static QString containerKey(Component *c)
+    {
+        return (c->container() != 0) ? c->container()->name() : QString();
+    }
+
+    bool lessThan(Component *a, Component *b) const
+    {
+        switch(m_column)
+        {
+            case ComponentModel::IDColumn:
+                return a->ID() < b->ID();
+            case ComponentModel::DescriptionColumn:
+                return a->description() < b->description();
+            case ComponentModel::DatasheetColumn:
+                return (a->defaultDatasheet() != 0) < (b->defaultDatasheet() != 0);
+            case ComponentModel::StockColumn:
+                return stockKey(a) < stockKey(b);
+            case ComponentModel::ContainerColumn:
+                return containerKey(a) < containerKey(b);
+            default:
+                return a->name() < b->name();
+        }
+    }
+};
+
+}
+
+ComponentModel::ComponentModel(CO *co, QObject *parent) :
+    QAbstractTableModel(parent),
+    m_co(co),
+    m_markLowStock(true),
+    m_sortColumn(-1),
+    m_sortOrder(Qt::AscendingOrder)
+{
+}
+
+int ComponentModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_components.count();
+}
+
+int ComponentModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ComponentModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || index.row() >= m_components.count())
+        return QVariant();
+
+    Component *component = m_components.at(index.row());
+
+    switch(role)
+    {
+        case Qt::DisplayRole:
+            switch(index.column())
+            {
+                case IDColumn:
+                    return component->ID();
+                case NameColumn:
+                    return component->name();
+                case DescriptionColumn:
+                    return component->description();
+                case DatasheetColumn:
+                {
+                    Component *link = component->isLinked() ? component->linkedTo() : component;
+                    return (link->defaultDatasheet() == 0) ? QString("n/a") : QString("view");
+                }
+                case StockColumn:
+                    if(component->ignoreStock())
+                        return QString("---");
+                    return component->totalStock();
+                case ContainerColumn:
+                    if(component->container() != 0)
+                        return component->container()->name();
+                    return QString();
+                default:
+                    return QVariant();
+            }
+
+        case Qt::TextAlignmentRole:
+            if(index.column() == DescriptionColumn)
+                return QVariant();
+            if(index.column() == ContainerColumn && component->container() == 0)
+                return QVariant();
+            return (int) Qt::AlignCenter;
+
+        case Qt::BackgroundRole:
+        {
+            if(!m_markLowStock || component->ignoreStock() || index.column() == IDColumn)
+                return QVariant();
+
+            if(component->totalStock() == 0)
+                return StockTable::withoutStockColor;
+
+            QVariant color;
+            foreach(const Stock &s, component->stocks())
+            {
+                if(s.stock() == 0)
+                    return StockTable::withoutStockColor;
+                else if(s.stock() <= s.lowValue())
+                    color = StockTable::lowStockColor;
+            }
+            return color;
+        }
+
+        default:
+            return QVariant();
+    }
+}
+
+QVariant ComponentModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QAbstractTableModel::headerData(section, orientation, role);
+
+    switch(section)
+    {
+        case IDColumn:
+            return tr("ID");
+        case NameColumn:
+            return tr("Code");
+        case DescriptionColumn:
+            return tr("Description");
+        case DatasheetColumn:
+            return tr("Datasheet");
+        case StockColumn:
+            return tr("Stock");
+        case ContainerColumn:
+            return tr("Container");
+        default:
+            return QVariant();
+    }
+}
+
+// A negative column leaves the rows as they are and keeps later lists in
+// the order they are given (search results by relevance)
+void ComponentModel::sort(int column, Qt::SortOrder order)
+{
+    m_sortColumn = column;
+    m_sortOrder = order;
+
+    if(column < 0)
+        return;
+
+    emit layoutAboutToBeChanged();
+
+    QModelIndexList oldIndexes = persistentIndexList();
+    QList<Component *> oldComponents;
+    foreach(const QModelIndex &index, oldIndexes)
+        oldComponents.append(m_components.at(index.row()));
+
+    qStableSort(m_components.begin(), m_components.end(), ComponentLessThan(column, order));
+    updateRows();
+
+    for(int i = 0; i < oldIndexes.count(); i++)
+        changePersistentIndex(oldIndexes.at(i),
+                              index(m_rows.value(oldComponents.at(i)), oldIndexes.at(i).column()));
+
+    emit layoutChanged();
+}
+
+void ComponentModel::setMarkLowStock(bool mark)
+{
+    if(m_markLowStock == mark)
+        return;
+
+    m_markLowStock = mark;
+    if(!m_components.isEmpty())
+        emit dataChanged(index(0, 0), index(m_components.count() - 1, ColumnCount - 1));
+}
+
+// Replaces the rows, keeping the current sort order. Only the rows that
+// come and go are reported to the view, so narrowing a search does not
+// rebuild the whole table; big changes fall back to a reset. Unsorted, the
+// rows take the order of 'components', which always needs a reset.
+void ComponentModel::setComponents(const QList<Component *> &components)
+{
+    const int maxChanges = 256;
+
+    QSet<Component *> wanted = components.toSet();
+    QList<Component *> added;
+    foreach(Component *c, components)
+        if(!m_rows.contains(c))
+            added.append(c);
+
+    int removedRanges = 0;
+    for(int i = m_components.count() - 1; i >= 0; i--)
+        if(!wanted.contains(m_components.at(i)) &&
+                (i == m_components.count() - 1 || wanted.contains(m_components.at(i + 1))))
+            removedRanges++;
+
+    if(m_sortColumn < 0 || m_components.isEmpty() || components.isEmpty() ||
+            removedRanges > maxChanges || added.count() > maxChanges)
+    {
+        QList<Component *> list = components;
+        if(m_sortColumn >= 0)
+            qStableSort(list.begin(), list.end(), ComponentLessThan(m_sortColumn, m_sortOrder));
+
+        beginResetModel();
+        m_components = list;
+        updateRows();
+        endResetModel();
+        return;
+    }
+
+    // Removals from the bottom up, one contiguous range at a time
+    int last = m_components.count() - 1;
+    while(last >= 0)
+    {
+        if(wanted.contains(m_components.at(last)))
+        {
+            last--;
+            continue;
+        }
+
+        int first = last;
+        while(first > 0 && !wanted.contains(m_components.at(first - 1)))
+            first--;
+
+        beginRemoveRows(QModelIndex(), first, last);
+        for(int i = last; i >= first; i--)
+            m_components.removeAt(i);
+        endRemoveRows();
+
+        last = first - 1;
+    }
+
+    ComponentLessThan lessThan(m_sortColumn, m_sortOrder);
+    foreach(Component *c, added)
+    {
+        int row = qUpperBound(m_components.begin(), m_components.end(), c, lessThan) - m_components.begin();
+        beginInsertRows(QModelIndex(), row, row);
+        m_components.insert(row, c);
+        endInsertRows();
+    }
+
+    updateRows();
+}
+
+Component *ComponentModel::component(int row) const
+{
+    if(row < 0 || row >= m_components.count())
+        return 0;
+
+    return m_components.at(row);
+}
+
+int ComponentModel::row(Component *component) const
+{
+    return m_rows.value(component, -1);
+}
+
+void ComponentModel::addComponent(Component *component)
+{
+    int row = m_components.count();
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_components.append(component);
+    m_rows.insert(component, row);
+    endInsertRows();
+}
+
+void ComponentModel::removeComponent(Component *component)
+{
+    int row = m_rows.value(component, -1);
+    if(row < 0)
+        return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_components.removeAt(row);
+    updateRows();
+    endRemoveRows();
+}
+
+void ComponentModel::updateComponent(Component *component)
+{
+    int row = m_rows.value(component, -1);
+    if(row >= 0)
+        emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+}
+
+void ComponentModel::clear()
+{
+    setComponents(QList<Component *>());
+}
+
+void ComponentModel::updateRows()
+{
+    m_rows.clear();
+    m_rows.reserve(m_components.count());
+    for(int i = 0; i < m_components.count(); i++)
+        m_rows.insert(m_components.at(i), i);
+}
@@ -0,0 +1,87 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef COMPONENTMODEL_H
+#define COMPONENTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include <QHash>
+#include <QSet>
+
+class CO;
+class Component;
+
+// Table model over the components shown by ComponentTable. It keeps only
+// the list of pointers; cells are computed when the view asks for them, so
+// the cost of a refresh does not depend on what is off screen.
+class ComponentModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum ColumnIndex
+    {
+        IDColumn = 0,
+        NameColumn = 1,
+        DescriptionColumn = 2,
+        DatasheetColumn = 3,
+        StockColumn = 4,
+        ContainerColumn = 5,
+        ColumnCount = 6
+    };
+
+    explicit ComponentModel(CO *co, QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+    void setMarkLowStock(bool mark);
+
+    int sortColumn() const
+    {
+        return m_sortColumn;
+    }
+
+    void setComponents(const QList<Component *> &components);
+    QList<Component *> components() const
+    {
+        return m_components;
+    }
+    Component *component(int row) const;
+    int row(Component *component) const;
+
+    void addComponent(Component *component);
+    void removeComponent(Component *component);
+    void updateComponent(Component *component);
+    void clear();
+
+private:
+    CO *m_co;
+    QList<Component *> m_components;
+    QHash<Component *, int> m_rows;
+    bool m_markLowStock;
+    int m_sortColumn;               // -1 while unsorted
+    Qt::SortOrder m_sortOrder;
+
+    void updateRows();
+};
+
+#endif // COMPONENTMODEL_H
@@ -17,44 +17,55 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 **********************************************************************/
 
 #include "componenttable.h"
+#include "pbuttondelegate.h"
 #include "co_defs.h"
 #include "co.h"
 #include "component.h"
 #include "datasheet.h"
-#include "container.h"
-#include "package.h"
-#include "stock.h"
-#include "ptoolbutton.h"
-#include "stocktable.h"
 
 #include <QApplication>
 #include <QHeaderView>
 #include <QAction>
-#include <QIcon>
 #include <QMenu>
-#include <QToolButton>
-#include <QLabel>
 #include <QMessageBox>
 
 #include <QDebug>
 
 ComponentTable::ComponentTable(CO *co, QWidget *parent) :
-    pTableWidget(parent),
+    QTableView(parent),
     m_co(co),
-    m_markLowStock(true)
+    m_selected(0)
 {
-    setColumnCount(6);
-    setDefaultSortedColumn(NameColumn);
+    m_model = new ComponentModel(co, this);
+    setModel(m_model);
 
-    QStringList headerLabels;
-    headerLabels.append(tr("ID"));
-    headerLabels.append(tr("Code"));
-    headerLabels.append(tr("Description"));
-    headerLabels.append(tr("Datasheet"));
-    headerLabels.append(tr("Stock"));
-    headerLabels.append(tr("Container"));
+    m_delegate = new pButtonDelegate(DatasheetColumn, this);
+    setItemDelegate(m_delegate);
+    setMouseTracking(true);
 
-    setHorizontalHeaderLabels(headerLabels);
+    // Same look as pTableWidget
+    QHeaderView *header;
+
+    header = horizontalHeader();
+    header->setHighlightSections(false);
+    header->setDefaultSectionSize(50);
+    header->show();
+
+    header = verticalHeader();
+    header->setDefaultSectionSize(21);
+    header->hide();
+
+    setFrameStyle(QFrame::NoFrame);
+
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setSelectionBehavior(QAbstractItemView::SelectRows);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    setAlternatingRowColors(true);
+    setWordWrap(false);
+
+    setSortingEnabled(true);
+    horizontalHeader()->setSortIndicatorShown(false);
 
     setColumnHidden(IDColumn, true);
     setColumnHidden(ContainerColumn, true);
@@ -85,129 +96,82 @@ ComponentTable::ComponentTable(CO *co, QWidget *parent) :
     connect(m_actionRemove, SIGNAL(triggered()), this, SLOT(removeHandler()));
     connect(m_actionNew, SIGNAL(triggered()), this, SIGNAL(newComponentRequest()));
 
-    connect(this, SIGNAL(itemSelectionChanged()), this, SLOT(itemSelectionChangedHandler()));
-    connect(this, SIGNAL(cellDoubleClicked(int, int)), this, SLOT(showDetailsHandler()));
+    setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(this, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(showContextMenu(QPoint)));
+
+    connect(m_delegate, SIGNAL(clicked(QModelIndex)), this, SLOT(viewDatasheetHandler(QModelIndex)));
+    connect(selectionModel(), SIGNAL(currentRowChanged(QModelIndex, QModelIndex)),
+            this, SLOT(currentRowChangedHandler(QModelIndex)));
+    connect(this, SIGNAL(doubleClicked(QModelIndex)), this, SLOT(showDetailsHandler()));
 }
 
 Component *ComponentTable::component(int row)
 {
-    int ID = item(row, IDColumn)->text().toInt();
-    return m_co->findComponent(ID);
+    return m_model->component(row);
 }
 
-void ComponentTable::fillRow(int row, Component *component)
+int ComponentTable::row(Component *component)
 {
-    bool changeColor = false;
-    QColor color;
-
-    if(m_markLowStock && !component->ignoreStock())
-    {
-        if(component->totalStock() == 0)
-        {
-            changeColor = true;
-            color = StockTable::withoutStockColor;
-        }
-        else
-        {
-            foreach(Stock *s, component->stocks())
-            {
-                if(s->stock() == 0)
-                {
-                    changeColor = true;
-                    color = StockTable::withoutStockColor;
-                    break;
-                }
-                else if(s->stock() <= s->lowValue())
-                {
-                    changeColor = true;
-                    color = StockTable::lowStockColor;
-                }
-            }
-        }
-    }
-
-    QTableWidgetItem *ID = new QTableWidgetItem(QString::number(component->ID()));
-
-    QTableWidgetItem *name = new QTableWidgetItem(component->name());
-    name->setTextAlignment(Qt::AlignCenter);
-    if(changeColor) name->setBackgroundColor(color);
-
-    QTableWidgetItem *desc = new QTableWidgetItem(component->description());
-    if(changeColor) desc->setBackgroundColor(color);
-
-    QTableWidgetItem *view = new QTableWidgetItem("");
-    view->setTextAlignment(Qt::AlignCenter);
-    if(changeColor) view->setBackgroundColor(color);
-
-    pToolButton *viewButton = new pToolButton(this);
-    if(changeColor) view->setBackgroundColor(color);
-
-    Component *link;
-    if(component->isLinked())
-        link = component->linkedTo();
-    else
-        link = component;
+    return m_model->row(component);
+}
 
-    if(link->defaultDatasheet() == 0)
-        viewButton->setText("n/a");
-    else
-        viewButton->setText("view");
+int ComponentTable::rowCount()
+{
+    return m_model->rowCount();
+}
 
-    viewButton->setNumber(row);
-    connect(viewButton, SIGNAL(pressed()), this, SLOT(updateSelectedRowFromToolButton()));
-    connect(viewButton, SIGNAL(clicked()), this, SLOT(viewDatasheetHandler()));
+int ComponentTable::currentRow()
+{
+    return currentIndex().row();
+}
 
-    QTableWidgetItem *stock;
-    if(component->ignoreStock())
-        stock = new QTableWidgetItem("---");
-    else
-        stock = new QTableWidgetItem(QString::number(component->totalStock()));
-    stock->setTextAlignment(Qt::AlignCenter);
-    if(changeColor) stock->setBackgroundColor(color);
+void ComponentTable::setCurrentRow(int row)
+{
+    setCurrentIndex(m_model->index(row, NameColumn));
+}
 
-    QTableWidgetItem *container = new QTableWidgetItem("");
-    if(component->container() != 0)
-    {
-        container->setText(component->container()->name());
-        container->setTextAlignment(Qt::AlignCenter);
-    }
-    if(changeColor) container->setBackgroundColor(color);
+// Replaces the rows, keeping the order chosen in the header
+void ComponentTable::setComponents(const QList<Component *> &components)
+{
+    m_selected = 0;
+    m_model->setComponents(components);
+}
 
-    setSortingEnabled(false);
-    setItem(row, IDColumn, ID);
-    setItem(row, NameColumn, name);
-    setItem(row, DescriptionColumn, desc);
-    setItem(row, DatasheetColumn, view);
-    setItem(row, StockColumn, stock);
-    setItem(row, ContainerColumn, container);
+// Shows the rows in the order they are set, until a header is clicked
+void ComponentTable::setUnsorted()
+{
+    horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    m_model->sort(-1);
+}
 
-    setCellWidget(row, DatasheetColumn, viewButton);
-    setSortingEnabled(true);
-    horizontalHeader()->setSortIndicatorShown(false);
+void ComponentTable::removeAll()
+{
+    m_selected = 0;
+    m_model->clear();
 }
 
 int ComponentTable::addComponent(Component *component)
 {
-    int row = rowCount();
-    insertRow(row);
-    fillRow(row, component);
-    updateToolButtonNumber();
-    return row;
+    m_model->addComponent(component);
+    return m_model->rowCount() - 1;
 }
 
 void ComponentTable::updateRowContents(int row)
 {
     Component *c = component(row);
-    removeRow(row);
-    insertRow(row);
-    fillRow(row, c);
-    updateToolButtonNumber();
-    setCurrentCell(row, 0);
+    if(c == 0)
+        return;
+
+    m_model->updateComponent(c);
+    setCurrentRow(row);
 }
 
-void ComponentTable::viewDatasheetHandler()
+void ComponentTable::viewDatasheetHandler(const QModelIndex &index)
 {
-    Component *c = component(currentRow());
+    Component *c = component(index.row());
+    if(c == 0)
+        return;
+
     Component *link;
 
     if(c->isLinked())
@@ -224,10 +188,6 @@ void ComponentTable::viewDatasheetHandler()
 
         m_co->execFile(fullPath);
     }
-    else
-    {
-
-    }
 }
 
 void ComponentTable::showDetailsHandler()
@@ -245,7 +205,7 @@ void ComponentTable::editHandler()
         emit editRequest(m_selected);
     }
 }
-#include <QScrollBar>
+
 void ComponentTable::removeHandler()
 {
     if(m_selected != 0)
@@ -258,24 +218,24 @@ void ComponentTable::removeHandler()
                                         QMessageBox::Yes, QMessageBox::No);
         if(res == QMessageBox::Yes)
         {
-            Component *c = component(currentRow());
+            Component *c = m_selected;
+            m_selected = 0;
+            m_model->removeComponent(c);
             m_co->removeComponent(c);
-
-            removeRow(currentRow());
         }
     }
 }
 
-void ComponentTable::itemSelectionChangedHandler()
+void ComponentTable::currentRowChangedHandler(const QModelIndex &current)
 {
-    m_selected = component(currentRow());
+    m_selected = component(current.row());
 }
 
 void ComponentTable::showContextMenu(const QPoint &pos)
 {
     if(!m_contextMenu->isEmpty())
     {
-        if(itemAt(pos) == 0)
+        if(!indexAt(pos).isValid())
         {
             m_actionShowDetails->setEnabled(false);
             m_actionEdit->setEnabled(false);
@@ -290,4 +250,3 @@ void ComponentTable::showContextMenu(const QPoint &pos)
         m_contextMenu->exec(viewport()->mapToGlobal(pos));
     }
 }
-
@@ -19,31 +19,48 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef COMPONENTTABLE_H
 #define COMPONENTTABLE_H
 
-#include "ptablewidget.h"
+#include <QTableView>
+
+#include "componentmodel.h"
 
 class CO;
 class Component;
 class QMenu;
+class pButtonDelegate;
 
-class ComponentTable : public pTableWidget
+class ComponentTable : public QTableView
 {
     Q_OBJECT
 public:
     enum ColumnIndex
     {
-        IDColumn = 0,
-        NameColumn = 1,
-        DescriptionColumn = 2,
-        DatasheetColumn = 3,
-        StockColumn = 4,
-        ContainerColumn = 5
+        IDColumn = ComponentModel::IDColumn,
+        NameColumn = ComponentModel::NameColumn,
+        DescriptionColumn = ComponentModel::DescriptionColumn,
+        DatasheetColumn = ComponentModel::DatasheetColumn,
+        StockColumn = ComponentModel::StockColumn,
+        ContainerColumn = ComponentModel::ContainerColumn
     };
 
     explicit ComponentTable(CO *co, QWidget *parent = 0);
 
-    void setMarkLowStock(bool mark) { m_markLowStock = mark; }
+    void setMarkLowStock(bool mark)
+    {
+        m_model->setMarkLowStock(mark);
+    }
     Component* component(int row);
+    int row(Component *component);
+    int rowCount();
+    int currentRow();
 
+    void setComponents(const QList<Component *> &components);
+    void removeAll();
+
+    void setUnsorted();
+    bool isSorted() const
+    {
+        return m_model->sortColumn() >= 0;
+    }
 
 signals:
     void showDetailsRequest(Component *);
@@ -55,16 +72,19 @@ public slots:
     int addComponent(Component *component);
     void updateRowContents(int row);
     void showContextMenu(const QPoint &pos);
+    void setCurrentRow(int row);
 
 private slots:
-    void viewDatasheetHandler();
+    void viewDatasheetHandler(const QModelIndex &index);
     void showDetailsHandler();
     void editHandler();
     void removeHandler();
-    void itemSelectionChangedHandler();
+    void currentRowChangedHandler(const QModelIndex &current);
 
 private:
     CO *m_co;
+    ComponentModel *m_model;
+    pButtonDelegate *m_delegate;
     Component *m_selected;
 
     QMenu *m_contextMenu;
@@ -72,11 +92,6 @@ private:
     QAction *m_actionEdit;
     QAction *m_actionRemove;
     QAction *m_actionNew;
-
-    bool m_markLowStock;
-
-    void fillRow(int row, Component *component);
-    
 };
 
 #endif // COMPONENTTABLE_H
@@ -0,0 +1,89 @@
+# Component Organizer
+# Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+QT       += core gui
+
+win32:CONFIG += qaxcontainer
+
+win32:TARGET = comporg_win
+unix:TARGET = comporg_unix
+TEMPLATE = app
+
+DEFINES += QT_NO_DEBUG_OUTPUT
+DEFINES += QT_NO_DEBUG
+
+win32:RC_FILE = ../resources/app.rc
+
+include(../core/core.pri)
+
+SOURCES += main.cpp \
+    ptablewidget.cpp \
+    mainwindow.cpp \
+    applicationnotetable.cpp \
+    componenttable.cpp \
+    componentdialog.cpp \
+    ptoolbutton.cpp \
+    componentdetails.cpp \
+    pminitablewidget.cpp \
+    datasheettable.cpp \
+    stocktable.cpp \
+    pspinbox.cpp \
+    optionsdialog.cpp \
+    applicationnotedialog.cpp \
+    componentmodel.cpp \
+    pbuttondelegate.cpp \
+    searchworker.cpp
+
+HEADERS  += ptablewidget.h \
+    mainwindow.h \
+    applicationnotetable.h \
+    componenttable.h \
+    componentdialog.h \
+    ptoolbutton.h \
+    componentdetails.h \
+    pminitablewidget.h \
+    datasheettable.h \
+    stocktable.h \
+    pspinbox.h \
+    optionsdialog.h \
+    applicationnotedialog.h \
+    componentmodel.h \
+    pbuttondelegate.h \
+    searchworker.h
+
+FORMS    += mainwindow.ui \
+    componentdialog.ui \
+    componentdetails.ui \
+    optionsdialog.ui \
+    applicationnotedialog.ui
+
+OBJECTS_DIR =   _build/tmp/obj
+MOC_DIR =       _build/tmp/moc
+RCC_DIR =       _build/tmp/rcc
+UI_DIR =        _build/tmp/ui
+
+CONFIG(debug, debug|release) {
+    DESTDIR = ../_build/debug/bin
+} else {
+    DESTDIR = ../_build/release/bin
+}
+
+
+RESOURCES += \
+    ../resources/img.qrc
+
+OTHER_FILES += \
+    ../resources/app.rc
@@ -32,6 +32,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "componentdetails.h"
 #include "applicationnotedialog.h"
 #include "optionsdialog.h"
+#include "searchworker.h"
 #include "container.h"
 
 #include "stock.h"
@@ -48,11 +49,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QSettings>
 #include <QDir>
 #include <QFileDialog>
+#ifdef Q_OS_WIN
 #include <QAxObject>
+#endif
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    m_textFiltered(false)
 {
     ui->setupUi(this);
 
@@ -89,6 +93,12 @@ MainWindow::MainWindow(QWidget *parent) :
     connect(ui->component_radioButton, SIGNAL(toggled(bool)), this, SLOT(changeView()));
     connect(ui->appnote_radioButton, SIGNAL(toggled(bool)), this, SLOT(changeView()));
 
+    m_searchWorker = new SearchWorker(co, this);
+    connect(m_searchWorker, SIGNAL(componentsFound(QList<Component *>)),
+            this, SLOT(showFoundComponents(QList<Component *>)));
+    connect(m_searchWorker, SIGNAL(applicationNotesFound(QList<ApplicationNote *>)),
+            this, SLOT(showFoundApplicationNotes(QList<ApplicationNote *>)));
+
     connect(ui->search_lineEdit, SIGNAL(textChanged(QString)), this, SLOT(search(QString)));
 
     connect(ui->actionExit, SIGNAL(triggered()), this, SLOT(close()));
@@ -113,8 +123,7 @@ MainWindow::MainWindow(QWidget *parent) :
     readSettings();
     resize(m_settings.width, m_settings.height);
 
-    foreach(Component *c, co->components())
-        componentTable->addComponent(c);
+    componentTable->setComponents(co->components());
     componentTable->sortByColumn(ComponentTable::NameColumn, Qt::AscendingOrder);
 
     foreach(ApplicationNote *a, co->applicationNotes())
@@ -123,7 +132,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
     /*for(int i=0; i < 20; i++)
     {
-        Component *c = new Component(QString("XPTO") + QString::number(i), co);
+        Component *c = new Component(QString("XPTO") + QString::number(i));
         c->setDescription("Description of XPTO");
         co->addComponent(c);
         componentTable->addComponent(c);
@@ -137,50 +146,45 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+// The query runs in the background; the matches come back through
+// showFoundComponents() and showFoundApplicationNotes()
 void MainWindow::search(QString searchText)
 {
     if(ui->component_radioButton->isChecked())
-    {
-        componentTable->removeAll();
-        if(searchText == "")
-        {
-            foreach(Component *c, co->components())
-                componentTable->addComponent(c);
-            componentTable->sortByColumn(ComponentTable::NameColumn, Qt::AscendingOrder);
-            return;
-        }
-        else
-        {
-            foreach(Component *c, co->components())
-            {
-                if(c->name().contains(searchText, Qt::CaseInsensitive) ||
-                        c->description().contains(searchText, Qt::CaseInsensitive))
-                    componentTable->addComponent(c);
-                componentTable->sortByColumn(ComponentTable::NameColumn, Qt::AscendingOrder);
-            }
-        }
-    }
+        m_searchWorker->search(searchText, SearchWorker::Components);
     else
-    {
-        appnoteTable->removeAll();
-        if(searchText == "")
-        {
-            foreach(ApplicationNote *a, co->applicationNotes())
-                appnoteTable->addApplicationNote(a);
-            appnoteTable->sortByColumn(ApplicationNoteTable::DescriptionColumn, Qt::AscendingOrder);
-            return;
-        }
-        else
-        {
-            foreach(ApplicationNote *a, co->applicationNotes())
-            {
-                if(a->description().contains(searchText, Qt::CaseInsensitive) ||
-                        a->name().contains(searchText, Qt::CaseInsensitive))
-                    appnoteTable->addApplicationNote(a);
-                appnoteTable->sortByColumn(ApplicationNoteTable::DescriptionColumn, Qt::AscendingOrder);
-            }
-        }
-    }
+        m_searchWorker->search(searchText, SearchWorker::ApplicationNotes);
+}
+
+void MainWindow::showFoundComponents(const QList<Component *> &components)
+{
+    // Kept as IDs: a component removed after the search must not be shown
+    m_foundComponents.clear();
+    foreach(Component *c, components)
+        m_foundComponents.append(c->ID());
+
+    // Search results come best match first; a header click still sorts them
+    bool wasFiltered = m_textFiltered;
+    m_textFiltered = !ui->search_lineEdit->text().isEmpty();
+    if(m_textFiltered && !wasFiltered)
+        componentTable->setUnsorted();
+    else if(!m_textFiltered && !componentTable->isSorted())
+        componentTable->sortByColumn(ComponentTable::NameColumn, Qt::AscendingOrder);
+
+    sortyBySelectedLabels();
+}
+
+void MainWindow::showFoundApplicationNotes(const QList<ApplicationNote *> &appnotes)
+{
+    bool ranked = !ui->search_lineEdit->text().isEmpty();
+
+    appnoteTable->removeAll();
+    if(ranked)
+        appnoteTable->sortByColumn(-1, Qt::AscendingOrder);   // keep the search order
+    foreach(ApplicationNote *a, appnotes)
+        appnoteTable->addApplicationNote(a);
+    if(!ranked)
+        appnoteTable->sortByColumn(ApplicationNoteTable::DescriptionColumn, Qt::AscendingOrder);
 }
 
 void MainWindow::changeView()
@@ -209,7 +213,7 @@ void MainWindow::showAddComponentDialog()
     {
         componentTable->addComponent(dialog.component());
         componentTable->sortByColumn(ComponentTable::NameColumn, Qt::AscendingOrder);
-        int row = componentTable->findText(dialog.component()->name(), ComponentTable::NameColumn);
+        int row = componentTable->row(dialog.component());
         componentTable->setCurrentRow(row);
         ui->component_radioButton->setChecked(true);
 
@@ -223,9 +227,10 @@ void MainWindow::showEditComponentDialog(Component *toEdit)
 
     if(dialog.exec() == QDialog::Accepted)
     {
+        co->componentChanged(dialog.component());
         componentTable->updateRowContents(componentTable->currentRow());
         componentTable->sortByColumn(ComponentTable::NameColumn, Qt::AscendingOrder);
-        int row = componentTable->findText(dialog.component()->name(), ComponentTable::NameColumn);
+        int row = componentTable->row(dialog.component());
         componentTable->setCurrentRow(row);
         componentTable->clearSelection();
 
@@ -237,6 +242,13 @@ void MainWindow::showComponentDetailsDialog(Component *component)
 {
     ComponentDetails dialog(co, component, this);
     dialog.exec();
+
+    // Only viewed: nothing to save
+    if(!dialog.stockModified() && !dialog.componentModified())
+        return;
+
+    if(dialog.componentModified())
+        co->componentChanged(component);
     componentTable->updateRowContents(componentTable->currentRow());
     componentTable->clearSelection();
     updateXML();
@@ -262,6 +274,7 @@ void MainWindow::showEditAppNoteDialog(ApplicationNote *appnote)
 
     if(dialog.exec() == QDialog::Accepted)
     {
+        co->applicationNoteChanged(appnote);
         appnoteTable->updateRowContents(appnoteTable->currentRow());
         appnoteTable->sortByColumn(ApplicationNoteTable::DescriptionColumn, Qt::AscendingOrder);
         appnoteTable->clearSelection();
@@ -291,10 +304,9 @@ void MainWindow::showOptionsDialog()
         componentTable->setMarkLowStock(false);
 
 
-    componentTable->removeAll();
-    foreach(Component *c, co->components())
-        componentTable->addComponent(c);
-
+    // Packages, labels or containers may have changed: show the current
+    // search and label filter again
+    sortyBySelectedLabels();
 }
 
 void MainWindow::primaryLabelChangedHandler()
@@ -310,7 +322,6 @@ void MainWindow::primaryLabelChangedHandler()
     {
         if(!labelName.isEmpty())
         {
-            componentTable->removeAll();
             Label *top = co->findTopLabel(labelName);
 
             if(top->leafs().isEmpty())
@@ -335,46 +346,49 @@ void MainWindow::secondaryLabelChangedHandler()
     sortyBySelectedLabels();
 }
 
+// Shows the components matching both the selected labels and the last
+// search. The label sets are kept by CO, so the cost follows the size of
+// the result rather than the number of components.
 void MainWindow::sortyBySelectedLabels()
 {
     QString pLabelName = ui->primaryLabel_comboBox->currentText();
     QString sLabelName = ui->secondaryLabel_comboBox->currentText();
 
-    componentTable->removeAll();
+    bool byLabel = (pLabelName != tr("[ALL]"));
+    QSet<Component *> labeled;
 
-    if(pLabelName == tr("[ALL]"))
-    {
-        foreach(Component *c, co->components())
-            componentTable->addComponent(c);
-        return;
-    }
     if(pLabelName == tr("[none]"))
+        labeled = co->unlabeledComponents();
+    else if(byLabel)
     {
-        foreach(Component *c, co->components())
-            if(c->primaryLabel() == 0)
-                componentTable->addComponent(c);
-        return;
-    }
-
-    foreach(Component *c, co->components())
-    {
-        if(c->primaryLabel() == 0)
-            continue;
-
-        if(c->primaryLabel()->name() == pLabelName)
+        Label *top = co->findTopLabel(pLabelName);
+        if(top != 0)
         {
             if(sLabelName.isEmpty())
-                componentTable->addComponent(c);
+                labeled = co->componentsWithLabel(top);
             else
             {
-                if(c->secondaryLabel() == 0)
-                    continue;
-
-                if(c->secondaryLabel()->name() == sLabelName)
-                    componentTable->addComponent(c);
+                Label *leaf = co->findSecondaryLabel(top, sLabelName);
+                if(leaf != 0)
+                    labeled = co->componentsWithLabels(top, leaf);
             }
         }
     }
+
+    if(!m_textFiltered)
+    {
+        componentTable->setComponents(byLabel ? labeled.toList() : co->components());
+        return;
+    }
+
+    QList<Component *> found;
+    foreach(int ID, m_foundComponents)
+    {
+        Component *c = co->findComponent(ID);
+        if(c != 0 && (!byLabel || labeled.contains(c)))
+            found.append(c);
+    }
+    componentTable->setComponents(found);
 }
 
 void MainWindow::readSettings()
@@ -452,6 +466,10 @@ void MainWindow::closeEvent(QCloseEvent *)
 
 void MainWindow::exportFile()
 {
+#ifndef Q_OS_WIN
+    // Export drives Excel through ActiveX, which only exists on Windows
+    QMessageBox::warning(this, tr("Export"), tr("Excel export is only available on Windows."));
+#else
     QString filepath = QFileDialog::getSaveFileName(this,
                        tr("Export Excel File"),
                        "Stock_" + QDateTime::currentDateTime().toString("dd_MM_yyyy"),
@@ -505,7 +523,7 @@ void MainWindow::exportFile()
             totalLowStock = 0;
             foreach(Package *p, co->getPackages())
             {
-                Stock *s = c->stock(p->name());
+                Stock *s = c->stock(p);
                 cellB->dynamicCall("SetValue(const QVariant&)", QVariant(c->description()));
                 if(c->container() != 0)
                 {
@@ -529,6 +547,7 @@ void MainWindow::exportFile()
         excel = NULL;
         QMessageBox::about(this, "Export", "Export Done..");
     }
+#endif
 }
 
 
@@ -20,12 +20,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QList>
 
 class CO;
 class Component;
 class ApplicationNote;
 class ComponentTable;
 class ApplicationNoteTable;
+class SearchWorker;
 
 namespace Ui
 {
@@ -77,6 +79,8 @@ private slots:
     void primaryLabelChangedHandler();
     void secondaryLabelChangedHandler();
     void exportFile();
+    void showFoundComponents(const QList<Component *> &components);
+    void showFoundApplicationNotes(const QList<ApplicationNote *> &appnotes);
 
 private:
     Ui::MainWindow *ui;
@@ -86,6 +90,10 @@ private:
     ComponentTable       *componentTable;
     ApplicationNoteTable *appnoteTable;
 
+    SearchWorker *m_searchWorker;
+    QList<int> m_foundComponents;           // IDs of the last search result
+    bool m_textFiltered;                    // false when the search box was empty
+
     Settings m_settings;
 
     void sortyBySelectedLabels();
@@ -36,16 +36,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "co_defs.h"
 #include "stock.h"
 #include "stocktable.h"
+#include "bom.h"
+#include "smtprogram.h"
+#include "stockreservation.h"
 
 #include <QListWidgetItem>
 #include <QMessageBox>
+#include <QFileInfo>
 #include <QSettings>
 #include <QFileDialog>
 
 #include <QDebug>
 
-#include <QAxObject>
-
 OptionsDialog::OptionsDialog(CO *co, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::OptionsDialog),
@@ -249,7 +251,7 @@ void OptionsDialog::addContainerHandler()
     m_containerTable->insertRow(row);
     m_containerTable->addItem(row, 0, name);
 
-    Container *container = new Container(name, m_co);
+    Container *container = new Container(name);
     m_co->addContainer(container);
 }
 
@@ -293,7 +295,7 @@ void OptionsDialog::addPackageHandler()
     m_packageTable->insertRow(row);
     m_packageTable->addItem(row, 0, name);
 
-    Package *package = new Package(name, m_co);
+    Package *package = new Package(name);
     m_co->addPackage(package);
 }
 
@@ -394,7 +396,7 @@ void OptionsDialog::addSecondaryLabelHandler()
     m_secondaryLabelTable->addItem(row, 0, name);
 
     Label *leaf = new Label(name, topLabel);
-    topLabel->addLeaf(leaf);
+    m_co->addSecondaryLabel(topLabel, leaf);
 }
 
 void OptionsDialog::removeSecondaryLabelHandler()
@@ -434,7 +436,7 @@ void OptionsDialog::addManufacturerHandler()
         return;
     }
 
-    Manufacturer *manufacturer = new Manufacturer(name, m_co);
+    Manufacturer *manufacturer = new Manufacturer(name);
     m_co->addManufacturer(manufacturer);
 
     m_manufacturerTable->removeAll();
@@ -539,7 +541,7 @@ QString filePath;
 
 void OptionsDialog::browseFile()
 {
-    filePath = QFileDialog::getOpenFileName(this, tr("Select Excel BOM File"), "", tr("BOM (*.xlsx *.xls)"));
+    filePath = QFileDialog::getOpenFileName(this, tr("Select Excel BOM File"), "", tr("BOM (*.xlsx *.csv)"));
 
     if(!filePath.isNull())
     {
@@ -576,84 +578,35 @@ void OptionsDialog::CheckBOM()
 
     ui->ProductInfo_textEdit->setText("File reading..\r\n");
 
-    QAxObject *excel = new QAxObject("Excel.Application", 0);
-    QAxObject *workbooks = excel->querySubObject("Workbooks");
-    QAxObject *workbook = workbooks->querySubObject("Open(const QString&)", filePath);
-    QAxObject *sheets = workbook->querySubObject("Worksheets");
-    QAxObject *sheet = sheets->querySubObject("Item( int )", 1);
+    Bom bom;
+    if(!bom.load(filePath))
+    {
+        ui->ProductInfo_textEdit->append(bom.errorString());
+        ui->PoductCheck_pushButton->setEnabled(true);
+        return;
+    }
 
-    bool FindComponentError = false;
     bool ReduceStockError = false;
     bool AddStockError = false;
-    int instock = 0;
-    int ComponentCount = 0;
 
-    for(int row = 2; row <= 999; row++)
+    foreach(const Bom::Shortage &shortage, bom.shortages(m_co, BOMCount))
     {
-        //------------- StockNo Find --------------
-        QAxObject *cell = sheet->querySubObject("Cells(int,int)", row, 1);
-        QString StockNo = cell->dynamicCall("Value()").toString();
-        cell = sheet->querySubObject("Cells(int,int)", row, 2);
-        int CountNumber = cell->dynamicCall("Value()").toInt() * BOMCount;
-        cell = sheet->querySubObject("Cells(int,int)", row, 3);
-        QString Designator = cell->dynamicCall("Value()").toString();
-
-        FindComponentError = true;
-
-        if(StockNo == "" && CountNumber == 0 && Designator == "")
-        {
-            break;
-        }
-
-        foreach(QString name, m_co->componentNames())
-        {
-            if(name == StockNo)
-            {
-                FindComponentError = false;
-                ComponentCount++;
-                foreach(Component *c, m_co->components())
-                {
-                    if(c->name() == name)
-                    {
-                        foreach(Package *p, m_co->getPackages())
-                        {
-                            Stock *s = c->stock(p->name());
-                            if(s)
-                            {
-                                instock = s->stock();
-                                break;
-                            }
-                        }
-                        break;
-                    }
-                }
-                break;
-            }
-        }
         //----------------- Count Check ---------------
-        if(FindComponentError == true)
+        ReduceStockError = true;
+        if(shortage.missing)
         {
-            ReduceStockError = true;
             AddStockError = true;
-            ui->ProductInfo_textEdit->append("Missing: " + StockNo  + " => " + Designator);
+            ui->ProductInfo_textEdit->append("Missing: " + shortage.partNumber  + " => " + shortage.designators);
+        }
+        else if(shortage.available == 0)
+        {
+            ui->ProductInfo_textEdit->append("No Stock: " + shortage.partNumber  + " => " + shortage.designators + "(-" + QString::number(shortage.required) + ")");
         }
         else
         {
-            if(instock == 0)
-            {
-                ReduceStockError = true;
-                ui->ProductInfo_textEdit->append("No Stock: " + StockNo  + " => " + Designator + "(-" + QString::number(CountNumber) + ")");
-            }
-            else if(instock < CountNumber)
-            {
-                ReduceStockError = true;
-                ui->ProductInfo_textEdit->append("Low Stock: " + StockNo  + " => " + Designator + "(-" + QString::number(CountNumber - instock) + ")");
-            }
+            ui->ProductInfo_textEdit->append("Low Stock: " + shortage.partNumber  + " => " + shortage.designators + "(-" + QString::number(shortage.required - shortage.available) + ")");
         }
-        //---------------------------------------------
     }
-    workbook->dynamicCall("Close()");
-    excel->dynamicCall("Quit()");
     ui->PoductCheck_pushButton->setEnabled(true);
     ui->PoductMax_pushButton->setEnabled(true);
     if(ReduceStockError == false)
@@ -664,7 +617,7 @@ void OptionsDialog::CheckBOM()
     {
         ui->PoductAdd_pushButton->setEnabled(true);
     }
-    if(ComponentCount && AddStockError == false && ReduceStockError == false)
+    if(!bom.isEmpty() && AddStockError == false && ReduceStockError == false)
     {
         ui->ProductInfo_textEdit->append("Has a enough stock.");
     }
@@ -697,60 +650,25 @@ void OptionsDialog::ReduceBOM()
 
     ui->ProductInfo_textEdit->setText("File Open..\r\n");
 
-    QAxObject *excel = new QAxObject("Excel.Application", 0);
-    QAxObject *workbooks = excel->querySubObject("Workbooks");
-    QAxObject *workbook = workbooks->querySubObject("Open(const QString&)", filePath);
-    QAxObject *sheets = workbook->querySubObject("Worksheets");
-    QAxObject *sheet = sheets->querySubObject("Item( int )", 1);
-
-    bool FindStock = false;
+    Bom bom;
+    if(!bom.load(filePath))
+    {
+        ui->ProductInfo_textEdit->append(bom.errorString());
+        ui->PoductCheck_pushButton->setEnabled(true);
+        return;
+    }
 
-    for(int row = 2; row <= 999; row++)
+    // Stock may have changed since the check; the kit is then left alone
+    StockReservation reservation(m_co);
+    reservation.setReference(QFileInfo(filePath).fileName());
+    reservation.addBom(bom, -BOMCount);
+    if(!reservation.commit())
     {
-        //------------- StockNo Find --------------
-        QAxObject *cell = sheet->querySubObject("Cells(int,int)", row, 1);
-        QString StockNo = cell->dynamicCall("Value()").toString();
-        cell = sheet->querySubObject("Cells(int,int)", row, 2);
-        int CountNumber = cell->dynamicCall("Value()").toInt() * BOMCount;
-        cell = sheet->querySubObject("Cells(int,int)", row, 3);
-        QString Designator = cell->dynamicCall("Value()").toString();
-
-        if(StockNo == "" && CountNumber == 0 && Designator == "")
-        {
-            if(FindStock == true)
-            {
-                ui->ProductInfo_textEdit->append("Reduce done...");
-            }
-            break;
-        }
-        FindStock = false;
-        foreach(QString name, m_co->componentNames())
-        {
-            if(name == StockNo)
-            {
-                FindStock = true;
-                foreach(Component *c, m_co->components())
-                {
-                    if(c->name() == name)
-                    {
-                        foreach(Package *p, m_co->getPackages())
-                        {
-                            Stock *s = c->stock(p->name());
-                            if(s)
-                            {
-                                s->setStock(s->stock() - CountNumber);
-                                c->setTotalStock(c->totalStock() - CountNumber);
-                                break;
-                            }
-                        }
-                    }
-                }
-                break;
-            }
-        }
+        ui->ProductInfo_textEdit->append(reservation.errorString() + ", nothing reduced. Check the BOM again.");
+        ui->PoductCheck_pushButton->setEnabled(true);
+        return;
     }
-    workbook->dynamicCall("Close()");
-    excel->dynamicCall("Quit()");
+    ui->ProductInfo_textEdit->append("Reduce done...");
     ui->PoductAdd_pushButton->setEnabled(true);
     ui->PoductCheck_pushButton->setEnabled(true);
     ui->PoductMax_pushButton->setEnabled(true);
@@ -782,60 +700,27 @@ void OptionsDialog::AddBOM()
 
     ui->ProductInfo_textEdit->setText("File Open..\r\n");
 
-    QAxObject *excel = new QAxObject("Excel.Application", 0);
-    QAxObject *workbooks = excel->querySubObject("Workbooks");
-    QAxObject *workbook = workbooks->querySubObject("Open(const QString&)", filePath);
-    QAxObject *sheets = workbook->querySubObject("Worksheets");
-    QAxObject *sheet = sheets->querySubObject("Item( int )", 1);
-
-    bool FindStock = false;
+    Bom bom;
+    if(!bom.load(filePath))
+    {
+        ui->ProductInfo_textEdit->append(bom.errorString());
+        ui->PoductCheck_pushButton->setEnabled(true);
+        return;
+    }
 
-    for(int row = 2; row <= 999; row++)
+    StockReservation reservation(m_co);
+    reservation.setReference(QFileInfo(filePath).fileName());
+    reservation.addBom(bom, BOMCount);
+    if(!reservation.commit(true))
     {
-        //------------- StockNo Find --------------
-        QAxObject *cell = sheet->querySubObject("Cells(int,int)", row, 1);
-        QString StockNo = cell->dynamicCall("Value()").toString();
-        cell = sheet->querySubObject("Cells(int,int)", row, 2);
-        int CountNumber = cell->dynamicCall("Value()").toInt() * BOMCount;
-        cell = sheet->querySubObject("Cells(int,int)", row, 3);
-        QString Designator = cell->dynamicCall("Value()").toString();
-
-        if(StockNo == "" && CountNumber == 0 && Designator == "")
-        {
-            if(FindStock == true)
-            {
-                ui->ProductInfo_textEdit->append("Add done...");
-            }
-            break;
-        }
-        FindStock = false;
-        foreach(QString name, m_co->componentNames())
-        {
-            if(name == StockNo)
-            {
-                FindStock = true;
-                foreach(Component *c, m_co->components())
-                {
-                    if(c->name() == name)
-                    {
-                        foreach(Package *p, m_co->getPackages())
-                        {
-                            Stock *s = c->stock(p->name());
-                            if(s)
-                            {
-                                s->setStock(s->stock() + CountNumber);
-                                c->setTotalStock(c->totalStock() + CountNumber);
-                                break;
-                            }
-                        }
-                    }
-                }
-                break;
-            }
-        }
+        ui->ProductInfo_textEdit->append(reservation.errorString());
+        ui->PoductCheck_pushButton->setEnabled(true);
+        return;
+    }
+    if(reservation.skipped().count() < bom.lines().count())
+    {
+        ui->ProductInfo_textEdit->append("Add done...");
     }
-    workbook->dynamicCall("Close()");
-    excel->dynamicCall("Quit()");
 
     ui->PoductAdd_pushButton->setEnabled(true);
     ui->PoductCheck_pushButton->setEnabled(true);
@@ -854,94 +739,28 @@ void OptionsDialog::MaximumBOMCalc()
 
     qApp->processEvents();
 
-    QAxObject *excel = new QAxObject("Excel.Application", 0);
-    QAxObject *workbooks = excel->querySubObject("Workbooks");
-    QAxObject *workbook = workbooks->querySubObject("Open(const QString&)", filePath);
-    QAxObject *sheets = workbook->querySubObject("Worksheets");
-    QAxObject *sheet = sheets->querySubObject("Item( int )", 1);
+    Bom bom;
+    if(!bom.load(filePath))
+    {
+        ui->ProductInfo_textEdit->append(bom.errorString());
+        ui->PoductCheck_pushButton->setEnabled(true);
+        return;
+    }
 
-    bool FindStock;
-    bool ReduceStockError;
-    bool AddStockError;
-    int instock;
-    int BOMCount = 1;
+    QString limitingPart;
+    int maximum = bom.maximumBuildable(m_co, &limitingPart);
 
-    while(BOMCount < 99999)
+    if(maximum > 0)
     {
-        FindStock = false;
-        ReduceStockError = false;
-        AddStockError = false;
-        instock = 0;
-
-        for(int row = 2; row <= 999; row++)
-        {
-            //------------- StockNo Find --------------
-            QAxObject *cell = sheet->querySubObject("Cells(int,int)", row, 1);
-            QString StockNo = cell->dynamicCall("Value()").toString();
-            cell = sheet->querySubObject("Cells(int,int)", row, 2);
-            int CountNumber = cell->dynamicCall("Value()").toInt() * BOMCount;
-            cell = sheet->querySubObject("Cells(int,int)", row, 3);
-            QString Designator = cell->dynamicCall("Value()").toString();
-
-            if(StockNo == "" && CountNumber == 0 && Designator == "")
-            {
-                break;
-            }
-            FindStock = false;
-            foreach(QString name, m_co->componentNames())
-            {
-                if(name == StockNo)
-                {
-                    FindStock = true;
-                    foreach(Component *c, m_co->components())
-                    {
-                        if(c->name() == name)
-                        {
-                            foreach(Package *p, m_co->getPackages())
-                            {
-                                Stock *s = c->stock(p->name());
-                                if(s)
-                                {
-                                    instock = s->stock();
-                                    break;
-                                }
-                            }
-                            break;
-                        }
-                    }
-                    break;
-                }
-            }
-            //----------------- Count Check ---------------
-            if(FindStock == false)
-            {
-                ReduceStockError = true;
-                AddStockError = true;
-                break;
-            }
-            else
-            {
-                if(instock < CountNumber)
-                {
-                    ReduceStockError = true;
-                    break;
-                }
-            }
-            //---------------------------------------------
-        }
-        if(ReduceStockError || AddStockError)
-        {
-            break;
-        }
-        else
-        {
-            ui->ProductBOMCount_spinBox->setValue(BOMCount);
-            BOMCount++;
-        }
+        ui->ProductBOMCount_spinBox->setValue(maximum);
     }
-    workbook->dynamicCall("Close()");
-    excel->dynamicCall("Quit()");
     CheckBOM();
+
+    ui->ProductInfo_textEdit->append("Maximum: " + QString::number(maximum));
+    if(!limitingPart.isEmpty())
+    {
+        ui->ProductInfo_textEdit->append("Limited by: " + limitingPart);
+    }
 }
 
 void OptionsDialog::CheckRequest()
@@ -957,7 +776,7 @@ QString PlacefilePath;
 
 void OptionsDialog::SmtBrowseBOMFile()
 {
-    BOMfilePath = QFileDialog::getOpenFileName(this, tr("Select Excel BOM File"), "", tr("BOM (*.xlsx *.xls)"));
+    BOMfilePath = QFileDialog::getOpenFileName(this, tr("Select Excel BOM File"), "", tr("BOM (*.xlsx *.csv)"));
 
     if(!BOMfilePath.isNull())
     {
@@ -981,7 +800,7 @@ void OptionsDialog::SmtBrowseBOMFile()
 
 void OptionsDialog::SmtBrowsePlaceFile()
 {
-    PlacefilePath = QFileDialog::getOpenFileName(this, tr("Select Excel PICK PLACE File"), "", tr("Place (*.xlsx *.xls)"));
+    PlacefilePath = QFileDialog::getOpenFileName(this, tr("Select Excel PICK PLACE File"), "", tr("Place (*.xlsx *.csv)"));
 
     if(!PlacefilePath.isNull())
     {
@@ -1013,412 +832,45 @@ void OptionsDialog::SmtGenerateFile()
     }
     ui->SmtInfo_textEdit->setText("Generatig please wait...");
     qApp->processEvents();
-    //---------------------------------
-    QStringList ERP_list;
-    QStringList BomDesignetor_list;
-
-    if(!ui->SkipBOM_checkBox->isChecked())
-    {
-        ui->SmtInfo_textEdit->append("BOM File reading.");
-
-        QAxObject *excel = new QAxObject("Excel.Application", 0);
-        QAxObject *workbooks = excel->querySubObject("Workbooks");
-        QAxObject *workbook = workbooks->querySubObject("Open(const QString&)", BOMfilePath);
-        QAxObject *sheets = workbook->querySubObject("Worksheets");
-        QAxObject *sheet = sheets->querySubObject("Item( int )", 1);
-
-        for(int row = 2; row <= 999; row++)
-        {
-            QAxObject *cell = sheet->querySubObject("Cells(int,int)", row, 1);
-            QString ERP_str = cell->dynamicCall("Value()").toString();
-            foreach(QString str, ERP_list)
-            {
-                if(str == ERP_str)
-                {
-                    ui->SmtInfo_textEdit->append(ERP_str + " ->ERP Number duplicated....");
-                    workbook->dynamicCall("Close()");
-                    excel->dynamicCall("Quit()");
-                    return;
-                }
-            }
-            ERP_list.append(ERP_str);
-            cell = sheet->querySubObject("Cells(int,int)", row, 3);
-            BomDesignetor_list.append(cell->dynamicCall("Value()").toString());
-
-            if(cell->dynamicCall("Value()").toString() == "")
-            {
-                break;
-            }
-        }
-        workbook->dynamicCall("Close()");
-        excel->dynamicCall("Quit()");
-        ui->SmtInfo_textEdit->append("BOM File read done...");
-    }
-    //---------------------------------
-    ui->SmtInfo_textEdit->append("Place File reading.");
-
-    QAxObject *excel = new QAxObject("Excel.Application", 0);
-    QAxObject *workbooks = excel->querySubObject("Workbooks");
-    QAxObject *workbook = workbooks->querySubObject("Open(const QString&)", PlacefilePath);
-    QAxObject *sheets = workbook->querySubObject("Worksheets");
-    QAxObject *sheet = sheets->querySubObject("Item( int )", 1);
-
-    QStringList CenterX_list;
-    QStringList CenterY_list;
-    QStringList Rotation_list;
-    QStringList PlaceDesignator_list;
-    QStringList PlaceERP_list;
-    QStringList ProfileName_list;
-    QStringList ProfileContent_list;
-    QStringList PlaceHead_list;
-    QString Result;
-
-    for(int row = 2; row <= 999; row++)
-    {
-        QAxObject *cell = sheet->querySubObject("Cells(int,int)", row, 1);
-        Result = cell->dynamicCall("Value()").toString();
-        if(Result == "")
-        {
-            break;
-        }
-        CenterX_list.append(Result);
-        cell = sheet->querySubObject("Cells(int,int)", row, 2);
-        CenterY_list.append(cell->dynamicCall("Value()").toString());
-        cell = sheet->querySubObject("Cells(int,int)", row, 3);
-        Rotation_list.append(cell->dynamicCall("Value()").toString());
-        cell = sheet->querySubObject("Cells(int,int)", row, 4);
-        PlaceDesignator_list.append(cell->dynamicCall("Value()").toString());
-        if(ui->SkipBOM_checkBox->isChecked())
-        {
-            cell = sheet->querySubObject("Cells(int,int)", row, 5);
-            PlaceERP_list.append(cell->dynamicCall("Value()").toString());
-        }
-    }
-    workbook->dynamicCall("Close()");
-    excel->dynamicCall("Quit()");
-    excel->deleteLater();
-    delete excel;
-    excel = NULL;
-    ui->SmtInfo_textEdit->append("Place File read done...");
-    //--------------------------------
-    // Read Temp file
-    QFile file(m_co->dirPath() + CO_SMT_PROFILE_PATH + "/board_temp.txt");
-    QString FileStr;
-    if(file.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        FileStr.append(file.readAll());
-    }
-    else
-    {
-        ui->SmtInfo_textEdit->setText("temp file error");
-        file.close();
-        return;
-    }
-    file.close();
-    int ProfileCount = 0;
-    //----------------------------------
-    if(ui->SkipBOM_checkBox->isChecked())
-    {
-        for(int i = 0; i < PlaceDesignator_list.size(); ++i)
-        {
-            Result = PlaceERP_list.at(i).toLocal8Bit().constData();
-            if(Result == "")
-            {
-                ui->SmtInfo_textEdit->append("ERROR Missing ERP Number;");
-                Result = PlaceDesignator_list.at(i).toLocal8Bit().constData();
-                ui->SmtInfo_textEdit->append(Result);
-                return;
-            }
-            bool skip  = false;
-            foreach(QString str, ProfileName_list)
-            {
-                if(str == Result)
-                {
-                    skip = true;
-                    break;
-                }
-            }
-            if(skip == false)
-            {
-                ProfileName_list.append(Result);
-                QFile Pfile(m_co->dirPath() + CO_SMT_PROFILE_PATH + '/' + Result + ".txt");
-                QString ProfileFileStr;
-                if(Pfile.open(QIODevice::ReadOnly | QIODevice::Text))
-                {
-                    ProfileFileStr.append(Pfile.readAll());
-                    Pfile.close();
-                    ProfileContent_list.append(ProfileFileStr);
-                    int point = ProfileFileStr.indexOf("HEAD");
-                    if(point == -1)
-                    {
-                        ui->SmtInfo_textEdit->setText(Result + ".txt file missing head info!");
-                        return;
-                    }
-                    QString heads;
-                    while(ProfileFileStr.at(point) != ' ')
-                    {
-                        if(ProfileFileStr.at(point) >= '1' && ProfileFileStr.at(point) <= '8')
-                        {
-                            heads.append(ProfileFileStr.at(point));
-                        }
-                        point++;
-                    }
-                    PlaceHead_list.append(heads);
-                    //Modified profile file index
-                    if(ProfileCount < 10)
-                    {
-                        ProfileFileStr.replace(5, 1, QString::number(ProfileCount));
-                    }
-                    else if(ProfileCount < 100)
-                    {
-                        ProfileFileStr.replace(4, 2, QString::number(ProfileCount));
-                    }
-                    else
-                    {
-                        ProfileFileStr.replace(3, 3, QString::number(ProfileCount));
-                    }
-                    ProfileCount++;
-                    //Added Profile file
-                    point = FileStr.indexOf("End_of_FD");
-                    FileStr.insert(point, ProfileFileStr);
-                }
-                else
-                {
-                    ui->SmtInfo_textEdit->setText(Result + ".txt file read error!");
-                    Pfile.close();
-                    return;
-                }
-            }
-        }
-    }
-    else
-    {
-        foreach(QString PlaceDesignator, PlaceDesignator_list)
-        {
-            int i = 0;
-            for(; i < BomDesignetor_list.size(); ++i)
-            {
-                Result = BomDesignetor_list.at(i).toLocal8Bit().constData();
-                QStringList ResultList = Result.split(',');
-                bool match = false;
-                foreach(QString str, ResultList)
-                {
-                    str.replace(" ", "");
-                    if(PlaceDesignator == str)
-                    {
-                        match = true;
-                        break;
-                    }
-                }
-                if(match == true)
-                {
-                    Result = ERP_list.at(i).toLocal8Bit().constData();
-                    if(Result == "")
-                    {
-                        ui->SmtInfo_textEdit->append("ERROR Missing ERP Number;");
-                        ui->SmtInfo_textEdit->append(PlaceDesignator);
-                        return;
-                    }
-                    PlaceERP_list.append(Result);
-                    bool skip = false;
-                    foreach(QString str, ProfileName_list)
-                    {
-                        if(str == Result)
-                        {
-                            skip = true;
-                            break;
-                        }
-                    }
-                    if(skip == false)
-                    {
-                        ProfileName_list.append(Result);
-                        QFile Pfile(m_co->dirPath() + CO_SMT_PROFILE_PATH + '/' + Result + ".txt");
-                        QString ProfileFileStr;
-                        if(Pfile.open(QIODevice::ReadOnly | QIODevice::Text))
-                        {
-                            ProfileFileStr.append(Pfile.readAll());
-                            Pfile.close();
-                            ProfileContent_list.append(ProfileFileStr);
-                            int point = ProfileFileStr.indexOf("HEAD");
-                            if(point == -1)
-                            {
-                                ui->SmtInfo_textEdit->setText(Result + ".txt file missing head info!");
-                                return;
-                            }
-                            QString heads;
-                            while(ProfileFileStr.at(point) != ' ')
-                            {
-                                if(ProfileFileStr.at(point) >= '1' && ProfileFileStr.at(point) <= '8')
-                                {
-                                    heads.append(ProfileFileStr.at(point));
-                                }
-                                point++;
-                            }
-                            PlaceHead_list.append(heads);
-                            //Modified profile file index
-                            if(ProfileCount < 10)
-                            {
-                                ProfileFileStr.replace(5, 1, QString::number(ProfileCount));
-                            }
-                            else if(ProfileCount < 100)
-                            {
-                                ProfileFileStr.replace(4, 2, QString::number(ProfileCount));
-                            }
-                            else
-                            {
-                                ProfileFileStr.replace(3, 3, QString::number(ProfileCount));
-                            }
-                            ProfileCount++;
-                            //Added Profile file
-                            point = FileStr.indexOf("End_of_FD");
-                            FileStr.insert(point, ProfileFileStr);
-                        }
-                        else
-                        {
-                            ui->SmtInfo_textEdit->setText(Result + ".txt file read error!");
-                            Pfile.close();
-                            return;
-                        }
-                    }
-                    else
-                     {
-                        ui->SmtInfo_textEdit->setText(Result + " Does not match Designator BOM to PLACE File!");
-                        //return;
-                    }
-                    //Result.append("=");// test
-                    //Result.append(PlaceDesignator);// test
-                    //ui->SmtInfo_textEdit->append(Result);// test
-                    break;
-                }
-            }
-            if(i == BomDesignetor_list.size())
-            {
-                ui->SmtInfo_textEdit->setText(PlaceDesignator + " -> Missing PLACE Designator on the BOM File!");
-                return;
-            }
-        }
-    }
 
-    // Write to prj name
-    if(ReplaceStr(&FileStr, "PCBNAME=", ui->SmtPcbName_lineEdit->text()) == false)
+    SmtPanel panel;
+    QString error;
+    if(!panel.parse(ui->SmtPanel_lineEdit->text(), &error))
     {
-        ui->SmtInfo_textEdit->setText("temp file cannot read PCBNAME!");
+        ui->SmtInfo_textEdit->setText(error);
         return;
     }
 
-    // Prepare cordinat str
-    QString PrepareStr;
-    QString TempStr;
-    int HeadShifter[PlaceHead_list.size()];
-
-    for(int i = 0; i < PlaceHead_list.size(); i++)
-    {
-        HeadShifter[i] = 0;
-    }
+    SmtProgram program(m_co->profileLibrary());
+    program.setOptimizeSequence(ui->SmtOptimize_checkBox->isChecked());
+    program.setPanel(panel);
+    QString bomPath = ui->SkipBOM_checkBox->isChecked() ? QString() : BOMfilePath;
 
-    for(int i = 0; i < CenterX_list.size(); ++i)
+    if(!program.generate(ui->SmtPcbName_lineEdit->text(), PlacefilePath, bomPath))
     {
-        TempStr = CenterX_list.at(i).toLocal8Bit().constData();
-        if(PrepareStrNumber(TempStr, &Result) == false)
-        {
-            ui->SmtInfo_textEdit->setText("Wrong number of Xcontent error.");
-            return;
-        }
-        PrepareStr.append(Result);
-        TempStr = CenterY_list.at(i).toLocal8Bit().constData();
-        if(PrepareStrNumber(TempStr, &Result) == false)
-        {
-            ui->SmtInfo_textEdit->setText("Wrong number of Ycontent error.");
-            return;
-        }
-        PrepareStr.append(Result);
-        if(PrepareStrNumber("0.00", &Result) == false)
-        {
-            ui->SmtInfo_textEdit->setText("Wrong number of 0content error.");
-            return;
-        }
-        PrepareStr.append(Result);
-        TempStr = Rotation_list.at(i).toLocal8Bit().constData();
-        if(TempStr == "360")
-        {
-            TempStr = "0";
-        }
-        TempStr.append(".00");
-        if(PrepareStrNumber(TempStr, &Result) == false)
-        {
-            ui->SmtInfo_textEdit->setText("Wrong number of Rot content error.");
-            return;
-        }
-        PrepareStr.append(Result);
-
-        PrepareStr.append("0A0000FFFF0001000");
-
-        for(int j = 0; j < ProfileName_list.size(); ++j)
-        {
-            QString profilenametemp = ProfileName_list.at(j).toLocal8Bit().constData();
-            QString placeerptemp = PlaceERP_list.at(i).toLocal8Bit().constData();
-            if(profilenametemp == placeerptemp)
-            {
-                QString headStr = PlaceHead_list.at(j).toLocal8Bit().constData();
-                QString number = headStr.at(HeadShifter[j]);
-                int temp = number.toInt();
-                HeadShifter[j]++;
-                if(HeadShifter[j] >= headStr.size())
-                {
-                    HeadShifter[j] = 0;
-                }
-                if(temp)
-                {
-                    temp--;
-                }
-                PrepareStr.append(QString::number(temp));//number of head
-
-                if(j < 16)
-                {
-                    PrepareStr.append("00FFFF0000000");
-                }
-                else
-                {
-                    PrepareStr.append("00FFFF000000");
-                }
-                PrepareStr.append(QString::number(j, 16).toUpper());//number of profile
-                break;
-            }
-        }
-
-        PrepareStr.append(' ');
-
-        TempStr = "                   \n";
-        Result = PlaceDesignator_list.at(i).toLocal8Bit().constData();
-        Result.append(">>>");
-        Result.append(PlaceERP_list.at(i).toLocal8Bit().constData());
-        TempStr.replace(0, Result.size(), Result);
-
-        PrepareStr.append(TempStr);
+        ui->SmtInfo_textEdit->setText(program.errorString());
+        return;
     }
 
-    int point = FileStr.indexOf("&B.OPT");
-    FileStr.insert(point, PrepareStr);
-
     ui->SmtInfo_textEdit->setText("File Generate Succesful...");
+    foreach(const QString &line, program.headSchedule().report())
+        ui->SmtInfo_textEdit->append(line);
+    ui->SmtInfo_textEdit->append(tr("Travel: %1 before, %2 after")
+                                 .arg(program.travelBefore(), 0, 'f', 1)
+                                 .arg(program.travelAfter(), 0, 'f', 1));
 
     PlacefilePath = QFileDialog::getSaveFileName(this, tr("Select Generate Yamaha SMT TXT File"), ui->SmtPcbName_lineEdit->text() + ".txt", tr("File (*.txt)"));
 
     if(!PlacefilePath.isNull())
     {
-        // Write target file
-        QFile file(PlacefilePath);
-        if(file.open(QIODevice::ReadWrite | QIODevice::Text))
+        if(program.save(PlacefilePath))
         {
-            QTextStream stream(&file);
-            stream << FileStr << endl;
             ui->SmtInfo_textEdit->append("File saved...");
         }
         else
         {
             ui->SmtInfo_textEdit->setText("Write file error!");
         }
-        file.close();
     }
     this->close();
 }
@@ -1454,49 +906,3 @@ void OptionsDialog::UpdateSkipBOM()
         }
     }
 }
-
-bool OptionsDialog::ReplaceStr(QString *filestr, QString target, QString newstr)
-{
-    int point = filestr->indexOf(target);
-
-    if(point == -1)
-    {
-        return false;
-    }
-
-    filestr->replace(target.size() + point, newstr.size(), newstr);
-
-    return true;
-}
-
-bool OptionsDialog::PrepareStrNumber(QString numberstr, QString *result)
-{
-    int point = numberstr.indexOf('.');
-    QString tempStr;
-    tempStr.append("        ");
-    switch(point)
-    {
-        case 0:
-            return false;
-        case 1:
-            tempStr.replace(4, numberstr.size(), numberstr);
-            break;
-        case 2:
-            tempStr.replace(3, numberstr.size(), numberstr);
-            break;
-        case 3:
-            tempStr.replace(2, numberstr.size(), numberstr);
-            break;
-        case 4:
-            tempStr.replace(1, numberstr.size(), numberstr);
-            break;
-        case 5:
-            tempStr.replace(0, numberstr.size(), numberstr);
-            break;
-    }
-    tempStr.resize(8);
-    tempStr.append(' ');
-    *result = tempStr;
-    return true;
-}
-
@@ -67,8 +67,6 @@ private slots:
     void SmtBrowsePlaceFile();
     void SmtGenerateFile();
     void UpdateSkipBOM();
-    bool ReplaceStr(QString *filestr, QString target, QString newstr);
-    bool PrepareStrNumber(QString numberstr, QString *result);
 
 private:
 
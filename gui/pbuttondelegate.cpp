@@ -0,0 +1,77 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "pbuttondelegate.h"
+
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOptionToolButton>
+
+pButtonDelegate::pButtonDelegate(int column, QObject *parent) :
+    QStyledItemDelegate(parent),
+    m_column(column)
+{
+}
+
+void pButtonDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if(index.column() != m_column)
+    {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    // Cell background (selection, low stock color) without the text
+    QStyleOptionViewItemV4 cell = option;
+    initStyleOption(&cell, index);
+    cell.text = QString();
+    const QWidget *widget = cell.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &cell, painter, widget);
+
+    QStyleOptionToolButton button;
+    button.rect = option.rect;
+    button.text = index.data(Qt::DisplayRole).toString();
+    button.font = option.font;
+    button.palette = option.palette;
+    button.toolButtonStyle = Qt::ToolButtonTextOnly;
+    button.state = QStyle::State_Enabled | QStyle::State_AutoRaise;
+    if(option.state & QStyle::State_MouseOver)
+        button.state |= QStyle::State_MouseOver | QStyle::State_Raised;
+    button.subControls = QStyle::SC_ToolButton;
+
+    style->drawComplexControl(QStyle::CC_ToolButton, &button, painter, widget);
+}
+
+bool pButtonDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
+                                  const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if(index.column() == m_column && event->type() == QEvent::MouseButtonRelease)
+    {
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+        if(mouseEvent->button() == Qt::LeftButton && option.rect.contains(mouseEvent->pos()))
+        {
+            emit clicked(index);
+            return true;
+        }
+    }
+
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
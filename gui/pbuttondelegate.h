@@ -0,0 +1,43 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef PBUTTONDELEGATE_H
+#define PBUTTONDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Paints the cells of one column as flat tool buttons and reports clicks,
+// instead of keeping a real button widget alive for every row.
+class pButtonDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit pButtonDelegate(int column, QObject *parent = 0);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+    bool editorEvent(QEvent *event, QAbstractItemModel *model,
+                     const QStyleOptionViewItem &option, const QModelIndex &index);
+
+signals:
+    void clicked(const QModelIndex &index);
+
+private:
+    int m_column;
+};
+
+#endif // PBUTTONDELEGATE_H
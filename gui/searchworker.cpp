@@ -0,0 +1,134 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include "searchworker.h"
+#include "co.h"
+#include "searchindex.h"
+
+#include <QtConcurrentRun>
+
+namespace
+{
+
+QList<int> runSearch(SearchIndex index, QString text, const QAtomicInt *stop)
+{
+    return index.search(text, stop);
+}
+
+}
+
+SearchWorker::SearchWorker(CO *co, QObject *parent) :
+    QObject(parent),
+    m_co(co),
+    m_stop(0),
+    m_target(Components),
+    m_pending(false),
+    m_runningTarget(Components)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(150);
+
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(start()));
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(finished()));
+}
+
+SearchWorker::~SearchWorker()
+{
+    m_stop = 1;
+    m_watcher.waitForFinished();
+}
+
+void SearchWorker::search(const QString &text, SearchWorker::Target target)
+{
+    m_text = text;
+    m_target = target;
+    m_pending = true;
+
+    if(m_watcher.isRunning())
+        m_stop = 1;
+
+    // An empty box lists everything, no need to wait
+    if(text.isEmpty())
+    {
+        m_timer.stop();
+        start();
+    }
+    else
+        m_timer.start();
+}
+
+void SearchWorker::start()
+{
+    // finished() starts the latest query once the running one is done
+    if(!m_pending || m_watcher.isRunning())
+        return;
+
+    m_pending = false;
+
+    if(m_text.isEmpty())
+    {
+        if(m_target == Components)
+            emit componentsFound(m_co->components());
+        else
+            emit applicationNotesFound(m_co->applicationNotes());
+        return;
+    }
+
+    SearchIndex index = (m_target == Components) ? m_co->componentIndex() : m_co->applicationNoteIndex();
+
+    m_stop = 0;
+    m_runningTarget = m_target;
+    m_watcher.setFuture(QtConcurrent::run(runSearch, index, m_text, (const QAtomicInt *) &m_stop));
+}
+
+void SearchWorker::finished()
+{
+    QList<int> ids = m_watcher.result();
+
+    if(!m_pending)
+        deliver(ids, m_runningTarget);
+    else if(!m_timer.isActive())
+        start();
+}
+
+void SearchWorker::deliver(const QList<int> &ids, Target target)
+{
+    // Items removed while the query was running are skipped
+    if(target == Components)
+    {
+        QList<Component *> found;
+        foreach(int id, ids)
+        {
+            Component *c = m_co->findComponent(id);
+            if(c != 0)
+                found.append(c);
+        }
+        emit componentsFound(found);
+    }
+    else
+    {
+        QList<ApplicationNote *> found;
+        foreach(int id, ids)
+        {
+            ApplicationNote *a = m_co->findApplicationNote(id);
+            if(a != 0)
+                found.append(a);
+        }
+        emit applicationNotesFound(found);
+    }
+}
@@ -0,0 +1,81 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#ifndef SEARCHWORKER_H
+#define SEARCHWORKER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include <QList>
+
+class CO;
+class Component;
+class ApplicationNote;
+
+// Runs the search box queries away from the GUI thread. Keystrokes are
+// collected until typing pauses, then the query runs in the thread pool
+// against a copy of the CO search index. Only one query runs at a time: a
+// newer one stops it and its result is dropped, so the tables are refreshed
+// once with the final result.
+class SearchWorker : public QObject
+{
+    Q_OBJECT
+public:
+    enum Target
+    {
+        Components,
+        ApplicationNotes
+    };
+
+    explicit SearchWorker(CO *co, QObject *parent = 0);
+    ~SearchWorker();
+
+    void setDelay(int msec)
+    {
+        m_timer.setInterval(msec);
+    }
+
+signals:
+    void componentsFound(const QList<Component *> &components);
+    void applicationNotesFound(const QList<ApplicationNote *> &appnotes);
+
+public slots:
+    void search(const QString &text, SearchWorker::Target target);
+
+private slots:
+    void start();
+    void finished();
+
+private:
+    CO *m_co;
+    QTimer m_timer;
+    QFutureWatcher<QList<int> > m_watcher;
+    QAtomicInt m_stop;
+
+    QString m_text;                 // latest query
+    Target m_target;
+    bool m_pending;                 // latest query not started yet
+
+    Target m_runningTarget;
+
+    void deliver(const QList<int> &ids, Target target);
+};
+
+#endif // SEARCHWORKER_H
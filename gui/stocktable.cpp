@@ -69,9 +69,9 @@ int StockTable::lowValue(int row)
     return low->value();
 }
 
-void StockTable::fillRow(int row, Stock *stock)
+void StockTable::fillRow(int row, const Stock &stock)
 {
-    QTableWidgetItem *packageItem = new QTableWidgetItem(stock->package()->name());
+    QTableWidgetItem *packageItem = new QTableWidgetItem(stock.package()->name());
     QTableWidgetItem *stockItem = new QTableWidgetItem("");
     QTableWidgetItem *lowItem = new QTableWidgetItem("");
     pSpinBox *stockWidget = new pSpinBox();
@@ -86,8 +86,8 @@ void StockTable::fillRow(int row, Stock *stock)
     stockWidget->setAlignment(Qt::AlignRight);
     lowWidget->setAlignment(Qt::AlignRight);
 
-    stockWidget->setValue(stock->stock());
-    lowWidget->setValue(stock->lowValue());
+    stockWidget->setValue(stock.stock());
+    lowWidget->setValue(stock.lowValue());
 
     setItem(row, PackageColumn, packageItem);
     setItem(row, StockColumn, stockItem);
@@ -99,7 +99,7 @@ void StockTable::fillRow(int row, Stock *stock)
     connect(lowWidget, SIGNAL(valueChanged(int)), this, SLOT(lowValueChangedHandler(int)));
 }
 
-int StockTable::addStock(Stock *stock)
+int StockTable::addStock(const Stock &stock)
 {
     int row = rowCount();
     insertRow(row);
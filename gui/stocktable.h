@@ -51,7 +51,7 @@ signals:
     void lowValueChanged(int row);
 
 public slots:
-    int addStock(Stock *stock);
+    int addStock(const Stock &stock);
 
 private slots:
     void stockChangedHandler(int newValue);
@@ -60,7 +60,7 @@ private slots:
 
 private:
 
-    void fillRow(int row, Stock *stock);
+    void fillRow(int row, const Stock &stock);
 
 };
 
@@ -0,0 +1,31 @@
+# Component Organizer
+# Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Unit tests of the core library, run by "make check"
+
+QT       += core gui testlib
+
+TARGET = tst_smtpanel
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+include(../core/core.pri)
+
+SOURCES += tst_smtpanel.cpp
+
+OBJECTS_DIR =   _build/tmp/obj
+MOC_DIR =       _build/tmp/moc
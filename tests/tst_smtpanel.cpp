@@ -0,0 +1,101 @@
+/*********************************************************************
+Component Organizer
+Copyright (C) Mrio Ribeiro (mario.ribas@gmail.com)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+**********************************************************************/
+
+#include <QtTest>
+
+#include "smtpanel.h"
+
+class TestSmtPanel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void rotatedBoardStaysInItsCell_data();
+    void rotatedBoardStaysInItsCell();
+    void unrotatedBoardIsOnlyMoved();
+    void rotationNeedsABoardSize();
+};
+
+void TestSmtPanel::rotatedBoardStaysInItsCell_data()
+{
+    QTest::addColumn<QString>("definition");
+    QTest::addColumn<QPointF>("size");
+
+    QTest::newRow("size from pitch") << QString("2x4 pitch=60,45 rotation=0,180") << QPointF(60, 45);
+    QTest::newRow("smaller board") << QString("2x4 pitch=60,45 size=50,40 rotation=0,180") << QPointF(50, 40);
+    QTest::newRow("single row") << QString("1x3 pitch=60,0 size=50,40 rotation=180") << QPointF(50, 40);
+}
+
+// Every corner of every board, turned or not, lands inside the board's
+// own cell of the panel
+void TestSmtPanel::rotatedBoardStaysInItsCell()
+{
+    QFETCH(QString, definition);
+    QFETCH(QPointF, size);
+
+    SmtPanel panel;
+    QString error;
+    QVERIFY2(panel.parse(definition, &error), qPrintable(error));
+
+    QList<QPointF> corners;
+    corners << QPointF(0, 0) << QPointF(size.x(), 0) << QPointF(0, size.y()) << size
+            << QPointF(1, 2);
+
+    for(int board = 0; board < panel.boardCount(); board++)
+    {
+        QRectF cell(60 * (board % panel.columns()), 45 * (board / panel.columns()), size.x(), size.y());
+        cell.adjust(-1e-6, -1e-6, 1e-6, 1e-6);
+
+        foreach(const QPointF &corner, corners)
+        {
+            QPointF p = panel.map(board, corner);
+            QVERIFY2(cell.contains(p), qPrintable(QString("board %1: (%2, %3) outside its cell")
+                                                  .arg(board).arg(p.x()).arg(p.y())));
+        }
+    }
+
+    // A 180 degree board is turned about its centre
+    if(panel.boardRotation(1 % panel.boardCount()) == 180)
+    {
+        int board = 1 % panel.boardCount();
+        QPointF origin(60 * (board % panel.columns()), 45 * (board / panel.columns()));
+        QCOMPARE(panel.map(board, QPointF(1, 2)), origin + size - QPointF(1, 2));
+    }
+}
+
+void TestSmtPanel::unrotatedBoardIsOnlyMoved()
+{
+    SmtPanel panel;
+    QString error;
+    QVERIFY(panel.parse("2x4 pitch=60,45 rotation=0,180", &error));
+
+    QCOMPARE(panel.map(0, QPointF(3, 4)), QPointF(3, 4));
+    QCOMPARE(panel.map(6, QPointF(3, 4)), QPointF(123, 49));
+}
+
+void TestSmtPanel::rotationNeedsABoardSize()
+{
+    SmtPanel panel;
+    QString error;
+    QVERIFY(!panel.parse("1x1 rotation=90", &error));
+    QVERIFY(!error.isEmpty());
+    QVERIFY(panel.parse("1x1 size=20,10 rotation=90", &error));
+}
+
+QTEST_MAIN(TestSmtPanel)
+#include "tst_smtpanel.moc"